@@ -0,0 +1,143 @@
+#ifndef ADDRESSABLELEONARDOHEAP_HPP
+#define ADDRESSABLELEONARDOHEAP_HPP
+
+#include <memory>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#include "IntrusiveLeonardoHeap.hpp"
+#include "RelaxedLeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * RelaxedHeap whose elements never leave their node: the repair steps move
+     * nodes through the forest instead of swapping values, so the node returned
+     * by push() is a stable handle until the element is popped or erased.  The
+     * nodes come from a pool and are linked by an IntrusiveRelaxedHeap.
+     */
+    template <class T, class Compare=std::less<T>, class Allocator=std::allocator<T>>
+    class AddressableRelaxedHeap {
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef Allocator allocator_type;
+            typedef std::size_t size_type;
+
+        private:
+        struct Node : RelaxedHook {
+            value_type value;
+
+            explicit Node(value_type&& v) : value(std::move(v)) {}
+        };
+
+        struct NodeCompare {
+            compare_type comp;
+
+            bool operator()(const Node& a, const Node& b) const {
+                return comp(a.value, b.value);
+            }
+        };
+
+        public:
+            typedef Node* handle_type;
+
+        private:
+        NodePool<Node, Allocator> pool;
+        IntrusiveRelaxedHeap<Node, NodeCompare> heap;
+
+        Node* create_node(value_type&& value) {
+            Node* node = pool.allocate();
+
+            try {
+                return new (node) Node(std::move(value));
+            } catch (...) {
+                pool.deallocate(node);
+                throw;
+            }
+        }
+
+        void destroy_node(Node* node) {
+            node->~Node();
+            pool.deallocate(node);
+        }
+
+        public:
+
+        AddressableRelaxedHeap (const compare_type& cmp = Compare(), const allocator_type& alloc = Allocator())
+            : pool(alloc), heap(NodeCompare {cmp}) {}
+
+        AddressableRelaxedHeap(const AddressableRelaxedHeap&) = delete;
+
+        AddressableRelaxedHeap& operator=(const AddressableRelaxedHeap&) = delete;
+
+        AddressableRelaxedHeap(AddressableRelaxedHeap&& other) noexcept
+            : pool(std::move(other.pool)), heap(std::move(other.heap)) {}
+
+        AddressableRelaxedHeap& operator=(AddressableRelaxedHeap&& other) noexcept {
+            if (this != &other) {
+                clear();
+                pool = std::move(other.pool);
+                heap = std::move(other.heap);
+            }
+
+            return *this;
+        }
+
+        ~AddressableRelaxedHeap() { clear(); }
+
+        handle_type push(value_type value) {
+            Node* node = create_node(std::move(value));
+            heap.push(*node);
+            return node;
+        }
+
+        void pop() {
+            Node* node = &heap.top();
+            heap.pop();
+            destroy_node(node);
+        }
+
+        /*
+         * Replace the value of `handle` by one that does not compare less, and
+         * move it up to where it belongs.
+         */
+        void decrease_key(handle_type handle, value_type value) {
+            heap.decrease_key(*handle, [&value] (Node& node) { node.value = std::move(value); });
+        }
+
+        void erase(handle_type handle) {
+            heap.unlink(*handle);
+            destroy_node(handle);
+        }
+
+        void clear() {
+            if (not std::is_trivially_destructible<value_type>::value)
+                heap.clear_and_dispose([] (Node& node) { node.~Node(); });
+            else
+                heap.clear();
+
+            pool.release();
+        }
+
+        static const value_type& value(handle_type handle) {
+            return handle->value;
+        }
+
+        const value_type& top() const {
+            return heap.top().value;
+        }
+
+        bool empty() const {
+            return heap.empty();
+        }
+
+        size_type size() const {
+            return heap.size();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef BOUNDEDLEONARDOHEAP_HPP
+#define BOUNDEDLEONARDOHEAP_HPP
+
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+#include "LeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * Fixed-capacity heap for streaming top-k: offer() keeps the `capacity`
+     * smallest values seen under Compare, so top() is the worst one kept.
+     * Use std::greater to keep the largest ones instead.  Storage is
+     * allocated once by the constructor.
+     */
+    template <class T, class Compare=std::less<T>>
+    class BoundedHeap {
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef std::size_t size_type;
+
+        private:
+        compare_type comp;
+        std::vector<value_type> c;
+        size_type bound;
+        HeapCode code;
+
+        public:
+
+        explicit BoundedHeap(size_type capacity, const compare_type& cmp = Compare())
+            : comp(cmp), bound(capacity), code{0LL, 1} {
+            c.reserve(capacity);
+        }
+
+        /*
+         * Keep `value` if the heap is not full or if it beats the current top,
+         * which is then dropped.  Returns whether `value` was kept.
+         */
+        bool offer(const value_type& value) {
+            if (c.size() < bound) {
+                c.push_back(value);
+                code = Leonardo::push_heap(std::prev(std::end(c)), code, comp);
+                return true;
+            }
+
+            if (0 == bound or not comp(value, c.back()))
+                return false;
+
+            c.back() = value;
+            Leonardo::replace_heap(std::prev(std::end(c)), code, comp);
+            return true;
+        }
+
+        void pop() {
+            code = Leonardo::pop_heap(std::prev(std::end(c)), code, comp);
+            c.pop_back();
+        }
+
+        // Move the kept values out in ascending order and leave the heap empty.
+        std::vector<value_type> take_sorted() {
+            std::vector<value_type> out;
+            out.reserve(bound);
+
+            Leonardo::sort_heap(std::begin(c), std::end(c), comp);
+            std::swap(out, c);
+            code = HeapCode{0LL, 1};
+            return out;
+        }
+
+        const value_type& top() const { return c.back(); }
+        bool empty() const { return c.empty(); }
+        bool full() const { return c.size() == bound; }
+        size_type size() const { return c.size(); }
+        size_type capacity() const { return bound; }
+    };
+}
+
+#endif
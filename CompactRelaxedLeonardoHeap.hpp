@@ -0,0 +1,313 @@
+#ifndef COMPACTRELAXEDLEONARDOHEAP_HPP
+#define COMPACTRELAXEDLEONARDOHEAP_HPP
+
+#include <memory>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace Leonardo {
+    /*
+     * RelaxedHeap with every node stored in one contiguous vector.  Links are
+     * 32-bit indices and the order shares a byte with the mark bit, so a node
+     * costs 13 bytes plus padding on top of its value.  pop() destroys the
+     * value of the slot it releases, and push() constructs a new one in place.
+     */
+    template <class T, class Compare=std::less<T>, class Allocator=std::allocator<T>>
+    class CompactRelaxedHeap {
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef Allocator allocator_type;
+            typedef uint32_t index_type;
+
+        private:
+        static constexpr index_type NIL = ~index_type(0);
+        static constexpr uint8_t MARK = 0x80;
+        static constexpr uint8_t FREE = 0xFF;     // order_mark of a slot on the free list; it holds no value
+
+        struct Node {
+            union { value_type value; };
+
+            index_type left, right;
+            index_type next;
+
+            uint8_t order_mark;
+
+            template <class... Args>
+            explicit Node(std::in_place_t, Args&&... args) : left(NIL), right(NIL), next(NIL), order_mark(1) {
+                new (&value) value_type(std::forward<Args>(args)...);
+            }
+
+            Node(const Node& other) : left(other.left), right(other.right), next(other.next), order_mark(FREE) {
+                if (not other.free())
+                    new (&value) value_type(other.value);
+
+                order_mark = other.order_mark;
+            }
+
+            Node(Node&& other) noexcept(std::is_nothrow_move_constructible<value_type>::value)
+                : left(other.left), right(other.right), next(other.next), order_mark(FREE) {
+                if (not other.free())
+                    new (&value) value_type(std::move(other.value));
+
+                order_mark = other.order_mark;
+            }
+
+            // Left free if the copy throws, so the slot is never destroyed twice.
+            Node& operator=(const Node& other) {
+                if (this != &other) {
+                    release();
+                    left = other.left;
+                    right = other.right;
+                    next = other.next;
+
+                    if (not other.free())
+                        new (&value) value_type(other.value);
+
+                    order_mark = other.order_mark;
+                }
+
+                return *this;
+            }
+
+            Node& operator=(Node&& other) noexcept(std::is_nothrow_move_constructible<value_type>::value) {
+                if (this != &other) {
+                    release();
+                    left = other.left;
+                    right = other.right;
+                    next = other.next;
+
+                    if (not other.free())
+                        new (&value) value_type(std::move(other.value));
+
+                    order_mark = other.order_mark;
+                }
+
+                return *this;
+            }
+
+            ~Node() { release(); }
+
+            // Destroy the value and mark the slot free.
+            void release() {
+                if (not free()) {
+                    value.~value_type();
+                    order_mark = FREE;
+                }
+            }
+
+            bool free() const { return FREE == order_mark; }
+
+            int order() const { return order_mark & ~MARK; }
+            bool marked() const { return order_mark & MARK; }
+
+            void set_order(int order) { order_mark = (order_mark & MARK) | (uint8_t)order; }
+            void set_marked(bool marked) { order_mark = marked ? (order_mark | MARK) : (order_mark & ~MARK); }
+        };
+
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Node> node_allocator;
+
+        compare_type comp;
+        std::vector<Node, node_allocator> nodes;
+        index_type root;
+        index_type free_list;
+
+        index_type get_proper_sub_node(index_type i) const {
+            const Node& node = nodes[i];
+
+            if (comp(nodes[node.left].value, nodes[node.right].value))
+                return node.right;
+            else
+                return node.left;
+        }
+
+        void semi_mark_sweep(index_type i) {
+            for (;;) {
+                Node& it = nodes[i];
+
+                if (it.order() > 1) {
+                    Node& child = nodes[get_proper_sub_node(i)];
+
+                    if (comp(it.value, child.value)) {
+                        std::swap(it.value, child.value);
+                        child.set_marked(it.marked());
+                        it.set_marked(false);
+
+                        if (child.order() > 1) {
+                            if (nodes[child.left].marked())
+                                i = child.left;
+                            else if (nodes[child.right].marked())
+                                i = child.right;
+                            else
+                                break;
+                        } else {
+                            child.set_marked(false);
+                            break;
+                        }
+                    } else {
+                        it.set_marked(false);
+                        break;
+                    }
+                } else {
+                    it.set_marked(false);
+                    break;
+                }
+            }
+        }
+
+        void mark_sweep(index_type i) {
+            const Node& node = nodes[i];
+
+            if (nodes[node.left].marked())
+                semi_mark_sweep(node.left);
+            else if (nodes[node.right].marked())
+                semi_mark_sweep(node.right);
+
+            semi_mark_sweep(i);
+        }
+
+        template <class... Args>
+        index_type create_node(Args&&... args) {
+            if (free_list != NIL) {
+                index_type i = free_list;
+                Node& node = nodes[i];
+
+                // A throwing constructor leaves the slot free and at the head of the list.
+                new (&node.value) value_type(std::forward<Args>(args)...);
+                free_list = node.next;
+                node.left = node.right = node.next = NIL;
+                node.order_mark = 1;
+                return i;
+            }
+
+            // NIL must stay a sentinel, so the last index it leaves is never handed out.
+            if (nodes.size() >= (std::size_t)NIL)
+                throw std::length_error("CompactRelaxedHeap: more than 2^32 - 1 nodes");
+
+            nodes.emplace_back(std::in_place, std::forward<Args>(args)...);
+            return (index_type)(nodes.size() - 1);
+        }
+
+        // Link a fresh single-node tree holding the new value into the forest.
+        void link(index_type i) {
+            if (empty()) {
+                root = i;
+                return;
+            }
+
+            Node& tmp = nodes[i];
+            Node& t1 = nodes[root];
+
+            if (comp(tmp.value, t1.value)) {
+                std::swap(tmp.value, t1.value);
+
+                if (t1.order() > 1) {
+                    t1.set_marked(true);
+                    mark_sweep(root);
+                }
+            }
+
+            if (t1.next != NIL && nodes[t1.next].order() == (t1.order() + 1)) {
+                Node& t2 = nodes[t1.next];
+
+                tmp.set_order(t2.order() + 1);
+                tmp.next = t2.next;
+                tmp.left = t1.next;
+                tmp.right = root;
+                t1.next = t2.next = NIL;
+            } else if (1 == t1.order()) {
+                tmp.set_order(0);
+                tmp.next = root;
+            } else {
+                tmp.set_order(1);
+                tmp.next = root;
+            }
+
+            root = i;
+        }
+
+        public:
+
+        CompactRelaxedHeap (const compare_type& cmp = Compare(), const allocator_type& alloc = Allocator())
+            : comp(cmp), nodes(node_allocator(alloc)), root(NIL), free_list(NIL) {}
+
+        void push(const value_type& value) {
+            link(create_node(value));
+        }
+
+        void push(value_type&& value) {
+            link(create_node(std::move(value)));
+        }
+
+        template <class... Args>
+        void emplace(Args&&... args) {
+            link(create_node(std::forward<Args>(args)...));
+        }
+
+        void pop() {
+            index_type old_root = root;
+            Node& node = nodes[root];
+
+            if (node.order() > 1) {
+                index_type l = node.left;
+                index_type r = node.right;
+
+                if (nodes[l].marked())
+                    semi_mark_sweep(l);
+                else if (nodes[r].marked())
+                    semi_mark_sweep(r);
+
+                nodes[l].next = node.next;
+                nodes[r].next = l;
+                root = r;
+            } else {
+                root = node.next;
+            }
+
+            node.release();
+            node.next = free_list;
+            free_list = old_root;
+
+            if (empty()) return;
+
+            index_type tmp = root;
+
+            for (index_type it = nodes[root].next; it != NIL; it = nodes[it].next)
+                if (comp(nodes[tmp].value, nodes[it].value))
+                    tmp = it;
+
+            if (tmp != root) {
+                std::swap(nodes[tmp].value, nodes[root].value);
+
+                if (nodes[tmp].order() > 1) {
+                    nodes[tmp].set_marked(true);
+                    mark_sweep(tmp);
+                }
+            }
+        }
+
+        void clear() {
+            nodes.clear();
+            root = free_list = NIL;
+        }
+
+        void reserve(std::size_t n) {
+            nodes.reserve(n);
+        }
+
+        const value_type& top() const {
+            return nodes[root].value;
+        }
+
+        bool empty() const {
+            return NIL == root;
+        }
+    };
+}
+
+#endif
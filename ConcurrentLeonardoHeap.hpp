@@ -0,0 +1,162 @@
+#ifndef CONCURRENTLEONARDOHEAP_HPP
+#define CONCURRENTLEONARDOHEAP_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "LeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * Relaxed concurrent priority queue in the MultiQueue style: factor * threads
+     * Leonardo::Heap shards, each behind its own spin lock.  push() goes to a
+     * random shard and try_pop() takes the better top of two random shards, so
+     * the returned element is expected to rank within O(shards) of the true top.
+     */
+    template <class T, class Compare=std::less<T>>
+    class MultiQueue {
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef std::size_t size_type;
+
+        private:
+        struct alignas(64) Shard {
+            std::atomic<bool> locked{false};
+            std::atomic<size_type> size{0};
+            Heap<T, std::vector<T>, Compare> heap;
+
+            bool try_lock() {
+                return not locked.load(std::memory_order_relaxed)
+                    and not locked.exchange(true, std::memory_order_acquire);
+            }
+
+            void lock() {
+                while (not try_lock())
+                    std::this_thread::yield();
+            }
+
+            void unlock() {
+                locked.store(false, std::memory_order_release);
+            }
+        };
+
+        compare_type comp;
+        size_type count;
+        std::unique_ptr<Shard[]> shards;
+
+        static size_type random(size_type n) {
+            static thread_local uint64_t state =
+                std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return (size_type)(state % n);
+        }
+
+        void pop_from(Shard& shard, value_type& out) {
+            out = shard.heap.pop_top();
+            shard.size.store(shard.heap.size(), std::memory_order_relaxed);
+        }
+
+        public:
+
+        explicit MultiQueue(size_type threads = std::thread::hardware_concurrency(), size_type factor = 2, const compare_type& cmp = Compare())
+            : comp(cmp), count(std::max<size_type>(2, threads * factor)), shards(new Shard[count]) {
+            for (size_type i = 0; i < count; i++)
+                shards[i].heap = Heap<T, std::vector<T>, Compare>(cmp);
+        }
+
+        void push(value_type value) {
+            for (;;) {
+                Shard& shard = shards[random(count)];
+
+                if (shard.try_lock()) {
+                    shard.heap.push(std::move(value));
+                    shard.size.store(shard.heap.size(), std::memory_order_relaxed);
+                    shard.unlock();
+                    return;
+                }
+            }
+        }
+
+        /*
+         * Pop an element close to the top into `out`.  Returns false only when
+         * every shard was seen empty.
+         */
+        bool try_pop(value_type& out) {
+            for (size_type attempt = 0; attempt < count; attempt++) {
+                size_type i = random(count);
+                size_type j = random(count - 1);
+                j += j >= i;
+
+                Shard* a = &shards[i];
+                Shard* b = &shards[j];
+
+                if (0 == a->size.load(std::memory_order_relaxed))
+                    std::swap(a, b);
+
+                if (0 == a->size.load(std::memory_order_relaxed) or not a->try_lock())
+                    continue;
+
+                if (a->heap.empty()) {
+                    a->unlock();
+                    continue;
+                }
+
+                if (b->size.load(std::memory_order_relaxed) and b->try_lock()) {
+                    if (not b->heap.empty() and comp(a->heap.top(), b->heap.top()))
+                        std::swap(a, b);
+
+                    b->unlock();
+                }
+
+                pop_from(*a, out);
+                a->unlock();
+                return true;
+            }
+
+            for (size_type i = 0; i < count; i++) {
+                Shard& shard = shards[i];
+                shard.lock();
+
+                if (not shard.heap.empty()) {
+                    pop_from(shard, out);
+                    shard.unlock();
+                    return true;
+                }
+
+                shard.unlock();
+            }
+
+            return false;
+        }
+
+        // Sum of the shard sizes; only a snapshot while other threads are running.
+        size_type size() const {
+            size_type n = 0;
+
+            for (size_type i = 0; i < count; i++)
+                n += shards[i].size.load(std::memory_order_relaxed);
+
+            return n;
+        }
+
+        bool empty() const {
+            return 0 == size();
+        }
+
+        size_type shard_count() const {
+            return count;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef INTRUSIVELEONARDOHEAP_HPP
+#define INTRUSIVELEONARDOHEAP_HPP
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+namespace Leonardo {
+    /*
+     * Links of an element in an IntrusiveRelaxedHeap; the element type derives
+     * from it.  Copying an element gives the copy fresh, unlinked links.
+     */
+    struct RelaxedHook {
+        RelaxedHook *left = nullptr, *right = nullptr;
+        RelaxedHook *next = nullptr;
+        RelaxedHook *parent = nullptr;
+
+        int order = 1;
+        bool marked = false;
+
+        RelaxedHook() = default;
+        RelaxedHook(const RelaxedHook&) {}
+        RelaxedHook& operator=(const RelaxedHook&) { return *this; }
+    };
+
+    /*
+     * RelaxedHeap over caller-owned objects.  push() and pop() link and unlink
+     * the objects themselves without allocating, and the repair steps move
+     * objects through the forest rather than swapping their contents.  An
+     * object must stay alive and at the same address while it is linked.
+     */
+    template <class T, class Compare=std::less<T>>
+    class IntrusiveRelaxedHeap {
+        static_assert(std::is_base_of<RelaxedHook, T>::value, "T must derive from Leonardo::RelaxedHook");
+
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef std::size_t size_type;
+
+        private:
+        typedef RelaxedHook Hook;
+
+        compare_type comp;
+        Hook* root;
+        size_type count;
+
+        static T& object(Hook* hook) {
+            return static_cast<T&>(*hook);
+        }
+
+        bool less(Hook* a, Hook* b) const {
+            return comp(object(a), object(b));
+        }
+
+        // Give an object that leaves the heap the links of a fresh one.
+        static void reset(Hook* hook) {
+            hook->left = hook->right = hook->next = hook->parent = nullptr;
+            hook->order = 1;
+            hook->marked = false;
+        }
+
+        Hook* get_proper_sub_node(Hook* node) const {
+            if (less(node->left, node->right))
+                return node->right;
+            else
+                return node->left;
+        }
+
+        // The link in the root list that points to `node`.
+        Hook** root_slot(Hook* node) {
+            Hook** slot = &root;
+
+            while (*slot != node)
+                slot = &(*slot)->next;
+
+            return slot;
+        }
+
+        void adopt_children(Hook* node) {
+            if (node->order > 1) {
+                node->left->parent = node;
+                node->right->parent = node;
+            }
+        }
+
+        // Detached `node` takes the place, order and mark of `old`, which is left detached.
+        void replace(Hook* old, Hook* node) {
+            if (old->parent) {
+                if (old->parent->left == old)
+                    old->parent->left = node;
+                else
+                    old->parent->right = node;
+            } else
+                *root_slot(old) = node;
+
+            node->left = old->left;
+            node->right = old->right;
+            node->next = old->next;
+            node->parent = old->parent;
+            node->order = old->order;
+            node->marked = old->marked;
+            adopt_children(node);
+
+            old->left = old->right = old->next = old->parent = nullptr;
+            old->marked = false;
+        }
+
+        // Exchange `child` with its parent; marks stay with the nodes.
+        void swap_with_parent(Hook* child) {
+            Hook* node = child->parent;
+            Hook* parent = node->parent;
+
+            if (parent) {
+                if (parent->left == node)
+                    parent->left = child;
+                else
+                    parent->right = child;
+            } else
+                *root_slot(node) = child;
+
+            Hook* left = child->left;
+            Hook* right = child->right;
+
+            if (node->left == child) {
+                child->left = node;
+                child->right = node->right;
+            } else {
+                child->left = node->left;
+                child->right = node;
+            }
+
+            node->left = left;
+            node->right = right;
+            std::swap(child->next, node->next);
+            std::swap(child->order, node->order);
+
+            child->parent = parent;
+            adopt_children(child);
+            adopt_children(node);
+        }
+
+        // Exchange two roots together with their places in the root list, orders and marks.
+        void swap_roots(Hook* a, Hook* b) {
+            Hook** slot_a = root_slot(a);
+            Hook** slot_b = root_slot(b);
+            Hook* a_next = a->next;
+            Hook* b_next = b->next;
+
+            if (a_next == b) {
+                *slot_a = b;
+                b->next = a;
+                a->next = b_next;
+            } else if (b_next == a) {
+                *slot_b = a;
+                a->next = b;
+                b->next = a_next;
+            } else {
+                *slot_a = b;
+                *slot_b = a;
+                a->next = b_next;
+                b->next = a_next;
+            }
+
+            std::swap(a->left, b->left);
+            std::swap(a->right, b->right);
+            std::swap(a->order, b->order);
+            std::swap(a->marked, b->marked);
+            adopt_children(a);
+            adopt_children(b);
+        }
+
+        void semi_mark_sweep(Hook* it) {
+            for (;;) {
+                if (it->order > 1) {
+                    Hook *child = get_proper_sub_node(it);
+
+                    if (less(it, child)) {
+                        swap_with_parent(child);
+                        child->marked = false;
+
+                        if (it->order > 1) {
+                            if (it->left->marked)
+                                it = it->left;
+                            else if (it->right->marked)
+                                it = it->right;
+                            else
+                                break;
+                        } else {
+                            it->marked = false;
+                            break;
+                        }
+                    } else {
+                        it->marked = false;
+                        break;
+                    }
+                } else {
+                    it->marked = false;
+                    break;
+                }
+            }
+        }
+
+        void mark_sweep(Hook* node) {
+            if (node->left->marked)
+                semi_mark_sweep(node->left);
+            else if (node->right->marked)
+                semi_mark_sweep(node->right);
+
+            semi_mark_sweep(node);
+        }
+
+        // Sweep marks until no node between `node` and its tree root is marked.
+        void settle(Hook* node) {
+            for (;;) {
+                Hook* marked = nullptr;
+
+                for (Hook* it = node; it; it = it->parent)
+                    if (it->marked)
+                        marked = it;
+
+                if (not marked)
+                    break;
+
+                semi_mark_sweep(marked);
+            }
+        }
+
+        template <class Dispose>
+        static void dispose_tree(Hook* node, Dispose& dispose) {
+            if (node->order > 1) {
+                dispose_tree(node->left, dispose);
+                dispose_tree(node->right, dispose);
+            }
+
+            dispose(object(node));
+        }
+
+        public:
+
+        explicit IntrusiveRelaxedHeap(const compare_type& cmp = Compare()) : comp(cmp), root(nullptr), count(0) {}
+
+        IntrusiveRelaxedHeap(const IntrusiveRelaxedHeap&) = delete;
+
+        IntrusiveRelaxedHeap& operator=(const IntrusiveRelaxedHeap&) = delete;
+
+        IntrusiveRelaxedHeap(IntrusiveRelaxedHeap&& other) noexcept
+            : comp(std::move(other.comp)), root(other.root), count(other.count) {
+            other.root = nullptr;
+            other.count = 0;
+        }
+
+        IntrusiveRelaxedHeap& operator=(IntrusiveRelaxedHeap&& other) noexcept {
+            if (this != &other) {
+                comp = std::move(other.comp);
+                root = other.root;
+                count = other.count;
+                other.root = nullptr;
+                other.count = 0;
+            }
+
+            return *this;
+        }
+
+        // Link `obj`, which must not be in a heap already.
+        void push(value_type& obj) {
+            Hook* node = &obj;
+            reset(node);
+            count++;
+
+            if (not root) {
+                root = node;
+                return;
+            }
+
+            Hook* tmp = node;
+
+            if (less(node, root)) {
+                tmp = root;
+                replace(tmp, node);
+
+                if (node->order > 1) {
+                    node->marked = true;
+                    mark_sweep(node);
+                }
+            }
+
+            Hook* t1 = root;
+            Hook* t2 = root->next;
+
+            if (t2 && t2->order == (t1->order + 1)) {
+                tmp->order = t2->order + 1;
+                tmp->next = t2->next;
+                tmp->left = t2;
+                tmp->right = t1;
+                t1->next = t2->next = nullptr;
+                t1->parent = t2->parent = tmp;
+                root = tmp;
+            } else if (1 == t1->order) {
+                tmp->order = 0;
+                tmp->next = root;
+                root = tmp;
+            } else {
+                tmp->order = 1;
+                tmp->next = root;
+                root = tmp;
+            }
+        }
+
+        // Unlink the top; the object itself is left alone.
+        void pop() {
+            Hook* old_root = root;
+
+            if (root->order > 1) {
+                if (root->left->marked)
+                    semi_mark_sweep(root->left);
+                else if (root->right->marked)
+                    semi_mark_sweep(root->right);
+
+                Hook* l = root->left;
+                Hook* r = root->right;
+
+                l->next = root->next;
+                r->next = l;
+                l->parent = r->parent = nullptr;
+                root = r;
+            } else {
+                root = root->next;
+            }
+
+            reset(old_root);
+            count--;
+
+            if (not root) return;
+
+            Hook* tmp = root;
+
+            for (Hook* it = root->next; it; it = it->next)
+                if (less(tmp, it))
+                    tmp = it;
+
+            if (tmp != root) {
+                Hook* head = root;
+                swap_roots(head, tmp);
+
+                if (head->order > 1) {
+                    head->marked = true;
+                    mark_sweep(head);
+                }
+            }
+        }
+
+        /*
+         * Let `change(obj)` update linked `obj` so that it does not compare
+         * less than before, then move `obj` up to where it belongs.
+         */
+        template <class Change>
+        void decrease_key(value_type& obj, Change&& change) {
+            Hook* node = &obj;
+
+            settle(node);
+            change(obj);
+
+            while (node->parent and less(node->parent, node))
+                swap_with_parent(node);
+
+            if (not node->parent and node != root and less(root, node))
+                swap_roots(root, node);
+        }
+
+        // Take linked `obj` out of the heap, e.g. to cancel it.
+        void unlink(value_type& obj) {
+            Hook* node = &obj;
+
+            settle(node);
+
+            while (node->parent)
+                swap_with_parent(node);
+
+            if (node != root)
+                swap_roots(root, node);
+
+            pop();
+        }
+
+        // Forget every element without touching it.
+        void clear() {
+            root = nullptr;
+            count = 0;
+        }
+
+        // Unlink every element and hand it to `dispose`, which may destroy it.
+        template <class Dispose>
+        void clear_and_dispose(Dispose dispose) {
+            for (Hook* it = root; it;) {
+                Hook* next = it->next;
+                dispose_tree(it, dispose);
+                it = next;
+            }
+
+            clear();
+        }
+
+        value_type& top() {
+            return object(root);
+        }
+
+        const value_type& top() const {
+            return object(root);
+        }
+
+        bool empty() const {
+            return not root;
+        }
+
+        size_type size() const {
+            return count;
+        }
+    };
+}
+
+#endif
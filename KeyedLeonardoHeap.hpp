@@ -0,0 +1,107 @@
+#ifndef KEYEDLEONARDOHEAP_HPP
+#define KEYEDLEONARDOHEAP_HPP
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "LeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * Leonardo::Heap over (key, slot) pairs with the payloads kept aside in
+     * an arena.  Sifting and trinkling only move the small pairs, and a
+     * payload stays at the same address from push() until it is popped.
+     */
+    template <class Key, class Payload, class Compare=std::less<Key>>
+    class KeyedHeap {
+        public:
+            typedef Key key_type;
+            typedef Payload payload_type;
+            typedef Compare compare_type;
+            typedef std::size_t size_type;
+            typedef uint32_t slot_type;
+
+        private:
+        struct Entry {
+            key_type key;
+            slot_type slot;
+        };
+
+        struct EntryCompare {
+            compare_type comp;
+
+            bool operator()(const Entry& a, const Entry& b) const {
+                return comp(a.key, b.key);
+            }
+        };
+
+        Heap<Entry, std::vector<Entry>, EntryCompare> heap;
+        std::deque<std::optional<payload_type>> arena;
+        std::vector<slot_type> free_slots;
+
+        template <class... Args>
+        slot_type store(Args&&... args) {
+            if (free_slots.empty()) {
+                // Every slot_type value names a payload; one more would wrap onto slot 0.
+                if (arena.size() > (size_type)std::numeric_limits<slot_type>::max())
+                    throw std::length_error("KeyedHeap: more than 2^32 payloads");
+
+                arena.emplace_back(std::in_place, std::forward<Args>(args)...);
+                return (slot_type)(arena.size() - 1);
+            }
+
+            slot_type slot = free_slots.back();
+            free_slots.pop_back();
+            arena[slot].emplace(std::forward<Args>(args)...);
+            return slot;
+        }
+
+        public:
+
+        explicit KeyedHeap(const compare_type& cmp = Compare()) : heap(EntryCompare {cmp}) {}
+
+        void push(const key_type& key, const payload_type& payload) {
+            heap.push(Entry {key, store(payload)});
+        }
+
+        void push(const key_type& key, payload_type&& payload) {
+            heap.push(Entry {key, store(std::move(payload))});
+        }
+
+        // Construct the payload in place from `args`.
+        template <class... Args>
+        void emplace(const key_type& key, Args&&... args) {
+            heap.push(Entry {key, store(std::forward<Args>(args)...)});
+        }
+
+        void pop() {
+            slot_type slot = heap.top().slot;
+
+            heap.pop();
+            arena[slot].reset();
+            free_slots.push_back(slot);
+        }
+
+        // Pop the top and hand its payload out by move.
+        payload_type pop_top() {
+            payload_type payload = std::move(*arena[heap.top().slot]);
+            pop();
+            return payload;
+        }
+
+        const key_type& top_key() const { return heap.top().key; }
+        payload_type& top() { return *arena[heap.top().slot]; }
+        const payload_type& top() const { return *arena[heap.top().slot]; }
+        bool empty() const { return heap.empty(); }
+        size_type size() const { return heap.size(); }
+    };
+}
+
+#endif
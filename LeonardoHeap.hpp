@@ -2,26 +2,58 @@
 #define LEONARDO_HEAP_H
 
 #include <algorithm>
+#include <array>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <iterator>
+#include <memory>
+#include <system_error>
+#include <type_traits>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace Leonardo {
-  int number[] = {
-    1, 1, 3, 5, 9, 15, 25, 41, 67, 109, 177,
-    287, 465, 753, 1219, 1973, 3193, 5167, 8361,
-    13529, 21891, 35421, 57313, 92735, 150049,
-    242785, 392835, 635621, 1028457, 1664079,
-    2692537, 4356617, 7049155, 11405773,
-    18454929, 29860703, 48315633, 78176337,
-    126491971, 204668309, 331160281, 535828591,
-    866988873, 1402817465
-  };
+  /*
+   * Leonardo numbers L(k) = L(k-1) + L(k-2) + 1, tree sizes of the heap.  L(91)
+   * is the last one below 2^64, enough for any heap that fits in memory.
+   */
+  constexpr std::size_t number_count = 92;
+
+  constexpr std::array<uint64_t, number_count> make_numbers() {
+    std::array<uint64_t, number_count> table{};
+    table[0] = table[1] = 1;
+
+    for (std::size_t k = 2; k < number_count; k++)
+      table[k] = table[k - 1] + table[k - 2] + 1;
+
+    return table;
+  }
+
+  inline constexpr std::array<uint64_t, number_count> number = make_numbers();
 
+  static_assert(number[44] == 2269806339ULL, "first tree order above 2^31");
+  static_assert(number[91] == 15080227609492692857ULL, "last tree order below 2^64");
+
+  /*
+   * Shape of the heap: bit i of prefix tells whether a tree of order shift + i
+   * is present.  The orders span up to 91 apart, hence 128 bits.
+   */
   struct HeapCode {
-    int64_t prefix;
+    __extension__ typedef unsigned __int128 prefix_type;
+
+    prefix_type prefix;
     int shift;
 
-    void increase() {
+    static constexpr int count_trailing_zeros(prefix_type x) {
+      uint64_t low = (uint64_t)x;
+      return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t)(x >> 64));
+    }
+
+    constexpr void increase() {
       if (3LL == (prefix & 3LL)) {
         prefix = (prefix >> 2) | 1LL;
         shift += 2;
@@ -35,7 +67,7 @@ namespace Leonardo {
         prefix = 1;
     }
 
-    void decrease() {
+    constexpr void decrease() {
       if (shift > 1) {
         prefix = (prefix << 2) ^ 7LL;
         shift -= 2;
@@ -43,38 +75,172 @@ namespace Leonardo {
         remove_least_digit();
     }
 
-    void remove_least_digit() {
+    constexpr void remove_least_digit() {
       prefix ^= 1LL;
 
       if (prefix) {
-        int t_shift = __builtin_ctzll(prefix);
+        int t_shift = count_trailing_zeros(prefix);
         prefix >>= t_shift;
         shift += t_shift;
       }
     }
 
-    void unguard_remove_least_digit() {
-      int t_shift = __builtin_ctzll(prefix ^ 1);
+    constexpr void unguard_remove_least_digit() {
+      int t_shift = count_trailing_zeros(prefix ^ 1);
       prefix >>= t_shift;
       shift += t_shift;
     }
 
+    constexpr int count_trees() const {
+      return __builtin_popcountll((uint64_t)prefix) + __builtin_popcountll((uint64_t)(prefix >> 64));
+    }
+
   };
 
-  template <class Iterator, class Compare>
-  constexpr void heap_sift(Iterator root, int heap_size_index, Compare comp) {
+  /*
+   * Statistics policies for the heaps and the free functions below.  Every
+   * hook of NullStats is empty, so the default policy compiles away.
+   */
+  struct NullStats {
+    constexpr void compare() {}
+    constexpr void sift(int) {}
+    constexpr void trinkle(int) {}
+    constexpr void swap() {}
+    constexpr void shape(const HeapCode&) {}
+    constexpr void mark() {}
+    constexpr void sweep(int) {}
+  };
+
+  // Counters of everything the heaps do; copy the struct to take a snapshot.
+  struct HeapStats {
+    uint64_t comparisons = 0;
+    uint64_t moves = 0;           // element copies and moves, three per swap
+    uint64_t sifts = 0;
+    uint64_t sift_depth[number_count] = {};  // sifts by the number of levels descended
+    uint64_t trinkles = 0;
+    uint64_t trinkle_roots = 0;   // roots visited by all the trinkles
+    uint64_t trees = 0;           // trees in the forest after the last operation
+    uint64_t max_trees = 0;
+    uint64_t marks = 0;           // RelaxedHeap nodes marked for a lazy sweep
+    uint64_t sweeps = 0;
+    uint64_t sweep_steps = 0;
+
+    void compare() { comparisons++; }
+
+    void sift(int depth) {
+      sifts++;
+      sift_depth[depth]++;
+      moves += depth + 2;
+    }
+
+    void trinkle(int roots) {
+      trinkles++;
+      trinkle_roots += roots;
+    }
+
+    void swap() { moves += 3; }
+
+    void shape(const HeapCode& code) {
+      trees = code.count_trees();
+      max_trees = std::max(max_trees, trees);
+    }
+
+    void mark() { marks++; }
+
+    void sweep(int steps) {
+      sweeps++;
+      sweep_steps += steps;
+    }
+  };
+
+  // Comparator that reports every call to a statistics policy.
+  template <class Compare, class Stats>
+  struct CountingCompare {
+    Compare comp;
+    Stats* stats;
+
+    template <class A, class B>
+    bool operator()(const A& a, const B& b) const {
+      stats->compare();
+      return comp(a, b);
+    }
+  };
+
+  /*
+   * std::less or std::greater over an arithmetic type: comparing has no side
+   * effects, so a root scan may pick the larger root with a conditional move
+   * instead of a branch.  heap_sift keeps its branches: a conditional move
+   * makes the next child address wait for the comparison, which costs more
+   * than the mispredictions once the tree is out of cache.
+   */
+  template <class Compare, class T>
+  struct is_branchless_compare : std::integral_constant<bool, std::is_arithmetic<T>::value and (
+      std::is_same<Compare, std::less<T>>::value or std::is_same<Compare, std::less<>>::value or
+      std::is_same<Compare, std::greater<T>>::value or std::is_same<Compare, std::greater<>>::value)> {};
+
+  // std::iter_swap, which is not constexpr before C++20, unless evaluated at compile time.
+  template <class Iterator>
+  constexpr void heap_iter_swap(Iterator a, Iterator b) {
+    if (__builtin_is_constant_evaluated()) {
+      typename std::iterator_traits<Iterator>::value_type tmp = std::move(*a);
+      *a = std::move(*b);
+      *b = std::move(tmp);
+    } else
+      std::iter_swap(a, b);
+  }
+
+  // Trees from this order up span more than the L1 cache for most element types.
+  constexpr int prefetch_order = 16;
+
+  /*
+   * Whether heap_sift may dereference grandchildren only to prefetch them.  An
+   * iterator whose dereference does work of its own, such as the journaling
+   * cursor of MappedHeap, opts out with a `typedef void no_prefetch;` member.
+   */
+  template <class Iterator, class = void>
+  struct heap_prefetchable : std::true_type {};
+
+  template <class Iterator>
+  struct heap_prefetchable<Iterator, std::void_t<typename Iterator::no_prefetch>> : std::false_type {};
+
+  // Start loading both children of the tree rooted at `root`, ahead of the next sift step.
+  template <class Iterator>
+  constexpr void heap_prefetch_children(Iterator root, int heap_size_index) {
+    typedef typename std::iterator_traits<Iterator>::iterator_category category_t;
+    typedef typename std::iterator_traits<Iterator>::reference reference_t;
+
+    if constexpr (heap_prefetchable<Iterator>::value and std::is_base_of<std::random_access_iterator_tag, category_t>::value
+                  and std::is_lvalue_reference<reference_t>::value) {
+      if (not __builtin_is_constant_evaluated()) {
+        Iterator right_child = std::prev(root);
+        Iterator left_child = std::prev(right_child, number[heap_size_index - 2]);
+
+        __builtin_prefetch(std::addressof(*right_child));
+        __builtin_prefetch(std::addressof(*left_child));
+      }
+    }
+  }
+
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr void heap_sift(Iterator root, int heap_size_index, Compare comp, Stats&& stats = Stats()) {
     typedef typename std::iterator_traits<Iterator>::value_type value_t;
 
     if (heap_size_index > 1) {
-      value_t value = *root;
+      value_t value = std::move(*root);
+      int depth = 0;
 
       do {
         Iterator right_child = std::prev(root);
         Iterator left_child = std::prev(right_child, number[heap_size_index - 2]);
 
+        if (heap_size_index >= prefetch_order) {
+          heap_prefetch_children(right_child, heap_size_index - 2);
+          heap_prefetch_children(left_child, heap_size_index - 1);
+        }
+
         if (comp(*left_child, *right_child)) {
           if (comp(value, *right_child)) {
-            *root = *right_child;
+            *root = std::move(*right_child);
             root = right_child;
 
             heap_size_index -= 2;
@@ -82,90 +248,612 @@ namespace Leonardo {
 
         } else {
           if (comp(value, *left_child)) {
-            *root = *left_child;
+            *root = std::move(*left_child);
             root = left_child;
 
             heap_size_index -= 1;
           } else break;
         }
+
+        depth++;
       } while (heap_size_index > 1);
 
-      *root = value;
+      *root = std::move(value);
+      stats.sift(depth);
     }
   }
 
-  template <class Iterator, class Compare>
-  constexpr void heap_trinkle(Iterator root, HeapCode code, Compare comp) {
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr void heap_trinkle(Iterator root, HeapCode code, Compare comp, Stats&& stats = Stats()) {
     if (code.prefix > 1LL) {
       Iterator max_heap_root = root;
       int max_heap_size_index = code.shift;
+      int roots = 0;
 
       Iterator heap_it = root;
 
       do {
-        std::advance(heap_it, -number[code.shift]);
+        heap_it = std::prev(heap_it, number[code.shift]);
         code.unguard_remove_least_digit();
+        roots++;
 
-        if (comp(*max_heap_root, *heap_it)) {
+        if constexpr (is_branchless_compare<Compare, typename std::iterator_traits<Iterator>::value_type>::value) {
+          bool larger = comp(*max_heap_root, *heap_it);
+          max_heap_root = larger ? heap_it : max_heap_root;
+          max_heap_size_index = larger ? code.shift : max_heap_size_index;
+        } else if (comp(*max_heap_root, *heap_it)) {
           max_heap_root = heap_it;
           max_heap_size_index = code.shift;
         }
       } while (code.prefix > 1LL);
 
+      stats.trinkle(roots);
+
       if (max_heap_root != root) {
-        std::iter_swap(max_heap_root, root);
-        heap_sift(max_heap_root, max_heap_size_index, comp);
+        heap_iter_swap(max_heap_root, root);
+        stats.swap();
+        heap_sift(max_heap_root, max_heap_size_index, comp, stats);
       }
     }
   }
 
-  template <class Iterator, class Compare>
-  constexpr HeapCode make_heap(Iterator first, Iterator last, Compare comp) {
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr HeapCode make_heap(Iterator first, Iterator last, Compare comp, Stats&& stats = Stats()) {
     HeapCode code{0LL, 1};
 
     if (first != last) {
       code.increase();
 
       for (Iterator prev_it = first, it = std::next(first); it != last; prev_it++, it++) {
-        if (comp(*prev_it, *it)) {
-          std::iter_swap(prev_it, it);
-          heap_sift(prev_it, code.shift, comp);
+        if (comp(*it, *prev_it)) {
+          heap_iter_swap(prev_it, it);
+          stats.swap();
+          heap_sift(prev_it, code.shift, comp, stats);
         }
 
         code.increase();
       }
     }
 
+    stats.shape(code);
     return code;
   }
 
-  template <class Iterator, class Compare>
-  constexpr HeapCode push_heap(Iterator root, HeapCode code, Compare comp) {
-    Iterator prev_root = std::prev(root);
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr HeapCode push_heap(Iterator root, HeapCode code, Compare comp, Stats&& stats = Stats()) {
+    // The first element has no previous root; std::prev(root) would point before the range.
+    if (code.prefix) {
+      Iterator prev_root = std::prev(root);
 
-    if (comp(*root, *prev_root)) {
-      std::iter_swap(root, prev_root);
-      heap_sift(prev_root, code.shift, comp);
+      if (comp(*root, *prev_root)) {
+        heap_iter_swap(root, prev_root);
+        stats.swap();
+        heap_sift(prev_root, code.shift, comp, stats);
+      }
     }
 
     code.increase();
+    stats.shape(code);
 
     return code;
   }
 
-  template <class Iterator, class Compare>
-  constexpr HeapCode pop_heap(Iterator root, HeapCode code, Compare comp) {
+  /*
+   * Integrate [first, last), appended right after the heap described by
+   * `code`.  Each new tree is sifted as it forms and the maximum is brought to
+   * the last root by a single trinkle at the end.
+   */
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr HeapCode push_heap(Iterator first, Iterator last, HeapCode code, Compare comp, Stats&& stats = Stats()) {
+    if (first != last) {
+      for (Iterator it = first; it != last; it++) {
+        code.increase();
+        heap_sift(it, code.shift, comp, stats);
+      }
+
+      heap_trinkle(std::prev(last), code, comp, stats);
+    }
+
+    stats.shape(code);
+    return code;
+  }
+
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr HeapCode pop_heap(Iterator root, HeapCode code, Compare comp, Stats&& stats = Stats()) {
     code.decrease();
-    heap_trinkle(std::prev(root), code, comp);
+    heap_trinkle(std::prev(root), code, comp, stats);
+    stats.shape(code);
+    return code;
+  }
+
+  /*
+   * Restore the heap after the top at `root` was overwritten.  The new top is
+   * the largest of the new value, the children of the last tree and the other
+   * roots, so at most one tree has to be sifted.
+   */
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr void replace_heap(Iterator root, HeapCode code, Compare comp, Stats&& stats = Stats()) {
+    const int root_size_index = code.shift;
+    Iterator max_heap_root = root;
+    int max_heap_size_index = root_size_index;
+    bool child_wins = false;
+
+    if (root_size_index > 1) {
+      Iterator right_child = std::prev(root);
+      Iterator left_child = std::prev(right_child, number[root_size_index - 2]);
+      Iterator child = comp(*left_child, *right_child) ? right_child : left_child;
+
+      if (comp(*root, *child)) {
+        max_heap_root = child;
+        child_wins = true;
+      }
+    }
+
+    Iterator heap_it = root;
+    int roots = 0;
+
+    while (code.prefix > 1LL) {
+      heap_it = std::prev(heap_it, number[code.shift]);
+      code.unguard_remove_least_digit();
+      roots++;
+
+      if (comp(*max_heap_root, *heap_it)) {
+        max_heap_root = heap_it;
+        max_heap_size_index = code.shift;
+        child_wins = false;
+      }
+    }
+
+    stats.trinkle(roots);
+
+    if (child_wins)
+      heap_sift(root, root_size_index, comp, stats);
+    else if (max_heap_root != root) {
+      heap_iter_swap(max_heap_root, root);
+      stats.swap();
+      heap_sift(max_heap_root, max_heap_size_index, comp, stats);
+    }
+  }
+
+  /*
+   * Keep the roots in ascending order from left to right, which is the
+   * invariant of Dijkstra's smoothsort.  The root at `root` is moved leftwards
+   * until its previous root is not greater, then sifted into its tree.  When
+   * `trusty` is set the tree at `root` is known to be heap ordered already.
+   */
+  template <class Iterator, class Compare>
+  constexpr void heap_ordered_trinkle(Iterator root, HeapCode code, bool trusty, Compare comp) {
+    while (code.prefix > 1LL) {
+      Iterator prev_root = std::prev(root, number[code.shift]);
+
+      if (not comp(*root, *prev_root))
+        break;
+
+      if (not trusty and code.shift > 1) {
+        Iterator right_child = std::prev(root);
+        Iterator left_child = std::prev(right_child, number[code.shift - 2]);
+
+        if (not comp(*right_child, *prev_root) or not comp(*left_child, *prev_root))
+          break;
+      }
+
+      heap_iter_swap(root, prev_root);
+      root = prev_root;
+      code.unguard_remove_least_digit();
+      trusty = false;
+    }
+
+    if (not trusty)
+      heap_sift(root, code.shift, comp);
+  }
+
+  template <class Iterator, class Compare>
+  constexpr HeapCode pop_ordered_heap(Iterator root, HeapCode code, Compare comp) {
+    if (code.shift > 1) {
+      Iterator right_child = std::prev(root);
+      Iterator left_child = std::prev(right_child, number[code.shift - 2]);
+
+      code.decrease();
+
+      HeapCode left_code = code;
+      left_code.unguard_remove_least_digit();
+
+      heap_ordered_trinkle(left_child, left_code, true, comp);
+      heap_ordered_trinkle(right_child, code, true, comp);
+    } else
+      code.decrease();
+
+    return code;
+  }
+
+  /*
+   * Pop the n greatest elements of the heap ending at `last`; they are left in
+   * [last - n, last) in ascending order, so the container only has to be
+   * shrunk once for the whole batch.
+   */
+  template <class Iterator, class Compare, class Stats = NullStats>
+  constexpr HeapCode pop_heap_n(Iterator last, std::size_t n, HeapCode code, Compare comp, Stats&& stats = Stats()) {
+    for (; n; n--)
+      code = Leonardo::pop_heap(--last, code, comp, stats);
+
+    return code;
+  }
+
+  // Shape of a heap of n elements: greedily the largest trees first, as push would build it.
+  constexpr HeapCode heap_code(uint64_t n) {
+    HeapCode code{0LL, 1};
+    int order = number_count - 1;
+
+    for (; n; n -= number[order]) {
+      while (number[order] > n)
+        order--;
+
+      // A second tree of size one has order 0.
+      if (code.prefix and order == code.shift)
+        order = 0;
+
+      if (code.prefix)
+        code.prefix = (code.prefix << (code.shift - order)) | 1LL;
+      else
+        code.prefix = 1;
+
+      code.shift = order;
+    }
+
+    return code;
+  }
+
+  template <class Iterator>
+  constexpr HeapCode heap_code(Iterator first, Iterator last) {
+    return heap_code((uint64_t)std::distance(first, last));
+  }
+
+  /*
+   * A task of parallel_make_heap on a thread of its own, or run inline when no
+   * thread can be started.  The destructor joins, so unwinding never leaves a
+   * joinable thread behind, and wait() rethrows what the task threw.
+   */
+  class HeapTask {
+    std::thread thread;
+    std::exception_ptr error;
+
+    public:
+
+    template <class Task>
+    explicit HeapTask(Task task) {
+      try {
+        thread = std::thread([this, task] () mutable {
+          try {
+            task();
+          } catch (...) {
+            error = std::current_exception();
+          }
+        });
+      } catch (const std::system_error&) {
+        task();
+      }
+    }
+
+    HeapTask(const HeapTask&) = delete;
+
+    HeapTask& operator=(const HeapTask&) = delete;
+
+    ~HeapTask() {
+      if (thread.joinable())
+        thread.join();
+    }
+
+    void wait() {
+      if (thread.joinable())
+        thread.join();
+
+      if (error)
+        std::rethrow_exception(error);
+    }
+  };
+
+  // Heapify the tree of `order` starting at `first`, splitting its subtrees over `threads` threads.
+  template <class Iterator, class Compare>
+  void parallel_make_tree(Iterator first, int order, Compare comp, unsigned threads) {
+    if (threads < 2 or order < 24) {
+      Leonardo::make_heap(first, std::next(first, number[order]), comp);
+      return;
+    }
+
+    Iterator right = std::next(first, number[order - 1]);
+    Iterator root = std::next(right, number[order - 2]);
+    unsigned left_threads = (unsigned)((double)threads * number[order - 1] / number[order]);
+
+    HeapTask left([=] { parallel_make_tree(first, order - 1, comp, left_threads); });
+    parallel_make_tree(right, order - 2, comp, threads - left_threads);
+    left.wait();
+
+    heap_sift(root, order, comp);
+  }
+
+  /*
+   * make_heap on up to `threads` threads: every tree of the forest, and every
+   * large subtree, is heapified on its own before the roots are trinkled.
+   * `comp` is copied into each thread.  Where a thread cannot be started its
+   * work runs on the calling thread.  An exception from `comp` is rethrown
+   * once every thread has stopped; as after make_heap, the contents of the
+   * range are then unspecified.
+   */
+  template <class Iterator, class Compare>
+  HeapCode parallel_make_heap(Iterator first, Iterator last, Compare comp, unsigned threads = std::thread::hardware_concurrency()) {
+    uint64_t n = std::distance(first, last);
+    HeapCode code = heap_code(n);
+    std::deque<HeapTask> workers;   // a deque never moves its tasks, which their threads point into
+
+    Iterator tree_last = last;
+
+    for (HeapCode it = code; tree_last != first; it.remove_least_digit()) {
+      Iterator tree = std::prev(tree_last, number[it.shift]);
+      unsigned share = (unsigned)((double)threads * number[it.shift] / n);
+      int order = it.shift;
+
+      if (share)
+        workers.emplace_back([=] { parallel_make_tree(tree, order, comp, share); });
+      else
+        parallel_make_tree(tree, order, comp, 1);
+
+      tree_last = tree;
+    }
+
+    for (HeapTask& worker : workers)
+      worker.wait();
+
+    if (first != last)
+      heap_trinkle(std::prev(last), code, comp);
+
     return code;
   }
 
-  template <class T, class Container = std::vector<T>, class Compare = std::less<typename Container::value_type>>
-  class Heap {
+  template <class Iterator, class Compare>
+  constexpr bool is_heap(Iterator first, Iterator last, Compare comp) {
+    HeapCode code{0LL, 1};
+
+    for (Iterator it = first; it != last; it++) {
+      if (3LL == (code.prefix & 3LL)) {
+        Iterator right_child = std::prev(it);
+        Iterator left_child = std::prev(right_child, number[code.shift]);
+
+        if (comp(*it, *left_child) or comp(*it, *right_child))
+          return false;
+      }
+
+      code.increase();
+    }
+
+    if (first != last) {
+      Iterator root = std::prev(last);
+      Iterator heap_it = root;
+
+      while (code.prefix > 1LL) {
+        heap_it = std::prev(heap_it, number[code.shift]);
+        code.unguard_remove_least_digit();
+
+        if (comp(*root, *heap_it))
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+  template <class Iterator>
+  constexpr bool is_heap(Iterator first, Iterator last) {
+    return Leonardo::is_heap(first, last, std::less<>());
+  }
+
+  template <class Iterator, class Compare>
+  constexpr void sort_heap(Iterator first, Iterator last, Compare comp) {
+    HeapCode code = heap_code(first, last);
+
+    for (Iterator it = last; it != first; it--)
+      code = Leonardo::pop_heap(std::prev(it), code, comp);
+  }
+
+  template <class Iterator>
+  constexpr void sort_heap(Iterator first, Iterator last) {
+    Leonardo::sort_heap(first, last, std::less<>());
+  }
+
+  /*
+   * Smoothsort: in place, O(1) extra memory, O(n log n) in the worst case and
+   * close to O(n) when the input is already nearly sorted.
+   */
+  template <class Iterator, class Compare>
+  constexpr void sort(Iterator first, Iterator last, Compare comp) {
+    HeapCode code{0LL, 1};
+    auto remain = std::distance(first, last);
+
+    for (Iterator it = first; it != last; it++) {
+      code.increase();
+      remain--;
+
+      // Only trees that will not be merged later have to be ordered among the roots.
+      if ((code.prefix & 2LL) ? remain == 0 : (uint64_t)remain <= number[code.shift - 1])
+        heap_ordered_trinkle(it, code, false, comp);
+      else
+        heap_sift(it, code.shift, comp);
+    }
+
+    for (Iterator it = last; it != first; it--)
+      code = Leonardo::pop_ordered_heap(std::prev(it), code, comp);
+  }
+
+  template <class Iterator>
+  constexpr void sort(Iterator first, Iterator last) {
+    Leonardo::sort(first, last, std::less<>());
+  }
+
+  /*
+   * Sort the middle - first smallest elements into [first, middle), leaving
+   * the rest in unspecified order.  The heap is built over the reversed range
+   * with the reversed comparison, so every pop leaves its element in place;
+   * O(n + k log n), and close to O(n) when the input is already ascending.
+   */
+  template <class Iterator, class Compare>
+  constexpr void partial_sort(Iterator first, Iterator middle, Iterator last, Compare comp) {
+    auto reverse_comp = [comp] (const auto& a, const auto& b) { return comp(b, a); };
+    std::reverse_iterator<Iterator> reverse_first(last), reverse_last(first);
+
+    HeapCode code = Leonardo::make_heap(reverse_first, reverse_last, reverse_comp);
+
+    for (; first != middle; first++, reverse_last--)
+      code = Leonardo::pop_heap(std::prev(reverse_last), code, reverse_comp);
+  }
+
+  template <class Iterator>
+  constexpr void partial_sort(Iterator first, Iterator middle, Iterator last) {
+    Leonardo::partial_sort(first, middle, last, std::less<>());
+  }
+
+  /*
+   * Put the element that belongs at `nth` there, with no greater element
+   * before it and no smaller one after it.  Pops from whichever end of the
+   * range is closer to `nth`, leaving that side sorted.
+   */
+  template <class Iterator, class Compare>
+  constexpr void nth_element(Iterator first, Iterator nth, Iterator last, Compare comp) {
+    if (nth == last)
+      return;
+
+    if (std::distance(first, nth) < std::distance(nth, last)) {
+      Leonardo::partial_sort(first, std::next(nth), last, comp);
+      return;
+    }
+
+    HeapCode code = Leonardo::make_heap(first, last, comp);
+
+    for (; last != nth; last--)
+      code = Leonardo::pop_heap(std::prev(last), code, comp);
+  }
+
+  template <class Iterator>
+  constexpr void nth_element(Iterator first, Iterator nth, Iterator last) {
+    Leonardo::nth_element(first, nth, last, std::less<>());
+  }
+
+  /*
+   * Walks a Leonardo heap in the order pop() would return its elements, ties
+   * aside, without changing it.  A frontier of candidate subtree roots starts
+   * with the roots of the forest, and taking the best candidate adds its two
+   * children, so the first k elements cost O(k log(k + trees)).  The view is
+   * invalid once the heap changes.
+   */
+  template <class Iterator, class Compare>
+  class OrderedView {
+    struct Candidate {
+      Iterator root;
+      int order;
+    };
+
+    struct CandidateCompare {
+      Compare comp;
+
+      bool operator()(const Candidate& a, const Candidate& b) const {
+        return comp(*a.root, *b.root);
+      }
+    };
+
+    CandidateCompare comp;
+    std::vector<Candidate> frontier;
+    HeapCode code;
+
+    void add(Iterator root, int order) {
+      frontier.push_back(Candidate {root, order});
+      code = Leonardo::push_heap(std::prev(std::end(frontier)), code, comp);
+    }
+
+    public:
+
+    typedef typename std::iterator_traits<Iterator>::value_type value_type;
+    typedef typename std::iterator_traits<Iterator>::reference reference;
+
+    struct sentinel {};
+
+    class iterator {
+      OrderedView* view;
+
+      public:
+
+      typedef std::input_iterator_tag iterator_category;
+      typedef typename OrderedView::value_type value_type;
+      typedef typename OrderedView::reference reference;
+      typedef typename std::iterator_traits<Iterator>::pointer pointer;
+      typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+
+      explicit iterator(OrderedView* view) : view(view) {}
+
+      reference operator*() const { return view->top(); }
+      iterator& operator++() { view->next(); return *this; }
+      void operator++(int) { view->next(); }
+      bool operator==(sentinel) const { return view->empty(); }
+      bool operator!=(sentinel) const { return not view->empty(); }
+    };
+
+    // The heap whose last element is `last`, with shape `code`.
+    OrderedView(Iterator last, HeapCode heap_code, const Compare& cmp) : comp {cmp}, code{0LL, 1} {
+      if (heap_code.prefix) {
+        Iterator root = std::prev(last);
+
+        for (;;) {
+          add(root, heap_code.shift);
+
+          if (heap_code.prefix <= 1LL)
+            break;
+
+          root = std::prev(root, number[heap_code.shift]);
+          heap_code.unguard_remove_least_digit();
+        }
+      }
+    }
+
+    reference top() const { return *frontier.back().root; }
+    bool empty() const { return frontier.empty(); }
+
+    void next() {
+      Candidate best = frontier.back();
+
+      code = Leonardo::pop_heap(std::prev(std::end(frontier)), code, comp);
+      frontier.pop_back();
+
+      if (best.order > 1) {
+        Iterator right_child = std::prev(best.root);
+
+        add(right_child, best.order - 2);
+        add(std::prev(right_child, number[best.order - 2]), best.order - 1);
+      }
+    }
+
+    iterator begin() { return iterator(this); }
+    sentinel end() const { return sentinel {}; }
+  };
+
+  /*
+   * Priority queue over a Leonardo heap.  Stats is a statistics policy such
+   * as HeapStats; the default NullStats records nothing and costs nothing.
+   */
+  template <class T, class Container = std::vector<T>, class Compare = std::less<typename Container::value_type>, class Stats = NullStats>
+  class Heap : private Stats {
     Compare comp;
     Container c;
     HeapCode code;
 
+    // The policy is a private base, so an empty one such as NullStats takes no space.
+    Stats& stats() { return *this; }
+    const Stats& stats() const { return *this; }
+
+    // The comparator handed to the free functions, counting calls unless stats are off.
+    auto counted_comp() {
+      if constexpr (std::is_same<Stats, NullStats>::value)
+        return comp;
+      else
+        return CountingCompare<Compare, Stats> {comp, &stats()};
+    }
+
     public:
 
     typedef Container continaer_type;
@@ -174,6 +862,7 @@ namespace Leonardo {
     typedef typename Container::size_type size_type;
     typedef typename Container::reference reference;
     typedef typename Container::const_reference const_reference;
+    typedef Stats stats_type;
 
     public:
 
@@ -181,9 +870,14 @@ namespace Leonardo {
 
     explicit Heap(const Compare& comp) : Heap(comp, Container()) {}
 
-    Heap(const Compare& comp, const Container& cont) : comp(comp), c(cont), code(Leonardo::make_heap(std::begin(c), std::end(c), comp)) {}
+    Heap(const Compare& comp, const Container& cont) : comp(comp), c(cont), code(Leonardo::make_heap(std::begin(c), std::end(c), counted_comp(), stats())) {}
+
+    Heap(const Compare& comp, Container&& cont) : comp(comp), c(std::move(cont)), code(Leonardo::make_heap(std::begin(c), std::end(c), counted_comp(), stats())) {}
 
-    Heap(const Compare& comp, Container&& cont) : comp(comp), c(std::move(cont)), code(Leonardo::make_heap(std::begin(c), std::end(c), comp)) {}
+    // Build the heap with parallel_make_heap on up to `threads` threads; its comparisons are not counted.
+    Heap(const Compare& comp, Container&& cont, unsigned threads) : comp(comp), c(std::move(cont)), code(Leonardo::parallel_make_heap(std::begin(c), std::end(c), comp, threads)) {
+      stats().shape(code);
+    }
 
     Heap(const Heap&) = default;
 
@@ -198,30 +892,106 @@ namespace Leonardo {
     void swap(Heap& other) noexcept(std::is_nothrow_swappable<Container>::value && std::is_nothrow_swappable<Compare>::value) {
       std::swap(c, other.c);
       std::swap(comp, other.comp);
+      std::swap(stats(), other.stats());
       std::swap(code, other.code);
     }
 
     template <class... Args>
     void emplace(Args&&... args) {
       c.emplace_back(std::forward<Args>(args)...);
-      code = Leonardo::push_heap(std::prev(std::end(c)), code, comp);
+      code = Leonardo::push_heap(std::prev(std::end(c)), code, counted_comp(), stats());
     }
 
     void push(const value_type& value) {
       c.push_back(value);
-      code = Leonardo::push_heap(std::prev(std::end(c)), code, comp);
+      code = Leonardo::push_heap(std::prev(std::end(c)), code, counted_comp(), stats());
     }
 
     void push(value_type&& value) {
       c.push_back(std::move(value));
-      code = Leonardo::push_heap(std::prev(std::end(c)), code, comp);
+      code = Leonardo::push_heap(std::prev(std::end(c)), code, counted_comp(), stats());
+    }
+
+    template <class InputIt>
+    void push_range(InputIt first, InputIt last) {
+      size_type n = c.size();
+      c.insert(std::end(c), first, last);
+      code = Leonardo::push_heap(std::next(std::begin(c), n), std::end(c), code, counted_comp(), stats());
     }
 
     void pop() {
-      code = Leonardo::pop_heap(std::prev(std::end(c)), code, comp);
+      code = Leonardo::pop_heap(std::prev(std::end(c)), code, counted_comp(), stats());
+      c.pop_back();
+    }
+
+    // Pop the top and hand it out by move; works for move-only value types.
+    value_type pop_top() {
+      code = Leonardo::pop_heap(std::prev(std::end(c)), code, counted_comp(), stats());
+      value_type value = std::move(c.back());
       c.pop_back();
+      return value;
+    }
+
+    // Overwrite the top with `value`; cheaper than pop() followed by push().
+    void replace_top(const value_type& value) {
+      c.back() = value;
+      Leonardo::replace_heap(std::prev(std::end(c)), code, counted_comp(), stats());
+    }
+
+    void replace_top(value_type&& value) {
+      c.back() = std::move(value);
+      Leonardo::replace_heap(std::prev(std::end(c)), code, counted_comp(), stats());
     }
 
+    // Move the min(n, size()) top elements to `out`, in the order pop() would return them.
+    template <class OutputIt>
+    OutputIt pop_k(size_type n, OutputIt out) {
+      n = std::min(n, c.size());
+      code = Leonardo::pop_heap_n(std::end(c), n, code, counted_comp(), stats());
+
+      auto last = std::end(c);
+      auto first = std::prev(last, n);
+
+      while (last != first)
+        *out++ = std::move(*--last);
+
+      c.erase(first, std::end(c));
+      return out;
+    }
+
+    template <class OutContainer>
+    void drain_into(OutContainer& out, size_type n) {
+      pop_k(n, std::back_inserter(out));
+    }
+
+    // Remove every element for which `pred` holds and rebuild the heap, in O(n); returns how many went.
+    template <class Predicate>
+    size_type erase_if(Predicate pred) {
+      auto first = std::remove_if(std::begin(c), std::end(c), pred);
+      size_type removed = (size_type)std::distance(first, std::end(c));
+
+      c.erase(first, std::end(c));
+      code = Leonardo::make_heap(std::begin(c), std::end(c), counted_comp(), stats());
+      return removed;
+    }
+
+    // The elements in pop() order, computed lazily and without touching the heap.
+    OrderedView<typename Container::const_iterator, Compare> ordered() const {
+      return OrderedView<typename Container::const_iterator, Compare>(std::end(c), code, comp);
+    }
+
+    // Copy the min(n, size()) top elements to `out` in pop() order, leaving the heap as it is.
+    template <class OutputIt>
+    OutputIt top_k(size_type n, OutputIt out) const {
+      for (auto view = ordered(); n and not view.empty(); n--, view.next())
+        *out++ = view.top();
+
+      return out;
+    }
+
+    // A copy of the counters so far.
+    Stats statistics() const { return stats(); }
+
     const_reference top() const { return c.back(); }
     bool empty() const { return c.empty(); }
     size_type size() const { return c.size(); }
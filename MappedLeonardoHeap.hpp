@@ -0,0 +1,416 @@
+#ifndef MAPPEDLEONARDOHEAP_HPP
+#define MAPPEDLEONARDOHEAP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "LeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * Leonardo heap kept in a memory-mapped file.  The file starts with a small
+     * header holding the element count and the HeapCode, followed by the heap
+     * array and a redo journal, so reopening an existing file costs one mmap
+     * and no make_heap pass.
+     *
+     * push() and pop() run on copies of the slots they touch.  The copies are
+     * written to the journal, the header marks the journal
+     * committed, and only then is the array updated.  A crash before the
+     * commit leaves the array as it was, and a crash after it is finished by
+     * replaying the journal when the file is opened, so only the interrupted
+     * push or pop may be lost.  Under Sync::always the same holds across a
+     * power cut: each step is msync'ed before the next one starts.
+     */
+    template <class T, class Compare=std::less<T>>
+    class MappedHeap {
+        static_assert(std::is_trivially_copyable<T>::value, "MappedHeap stores raw bytes of T");
+        static_assert(alignof(T) <= 64, "MappedHeap aligns the heap array to 64 bytes");
+
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef std::size_t size_type;
+
+            enum class Sync {
+                never,      // leave write-back to the kernel
+                on_close,   // msync in sync() and in the destructor
+                always      // msync journal, header and array in order within every push and pop
+            };
+
+        private:
+        static constexpr uint64_t MAGIC = 0x32504145484f454cULL;  // "LEOHEAP2"
+
+        struct Header {
+            uint64_t magic;
+            uint64_t element_size;
+            uint64_t size;
+            uint64_t capacity;
+            uint64_t committed;     // the journal holds an update not yet applied to the array
+            uint64_t records;
+            uint64_t next_size;     // size and shape once that update is applied
+            HeapCode next_code;
+            HeapCode code;
+        };
+
+        struct Record {
+            uint64_t index;
+            value_type value;
+        };
+
+        // Entry of the index over the staged records; free unless it carries the current epoch.
+        struct Slot {
+            Record* record;
+            uint64_t epoch;
+        };
+
+        // Random-access iterator over the heap as the update in flight sees it.
+        class Cursor {
+            MappedHeap* heap;
+            uint64_t pos;
+
+            public:
+
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef int64_t difference_type;
+            typedef T* pointer;
+            typedef T& reference;
+            typedef void no_prefetch;   // a dereference stages the slot into the journal
+
+            Cursor(MappedHeap* heap, uint64_t pos) : heap(heap), pos(pos) {}
+
+            reference operator*() const { return heap->stage(pos); }
+            reference operator[](difference_type n) const { return heap->stage(pos + n); }
+
+            Cursor& operator++() { pos++; return *this; }
+            Cursor operator++(int) { Cursor old = *this; pos++; return old; }
+            Cursor& operator--() { pos--; return *this; }
+            Cursor operator--(int) { Cursor old = *this; pos--; return old; }
+            Cursor& operator+=(difference_type n) { pos += n; return *this; }
+            Cursor& operator-=(difference_type n) { pos -= n; return *this; }
+
+            friend Cursor operator+(Cursor it, difference_type n) { return it += n; }
+            friend Cursor operator+(difference_type n, Cursor it) { return it += n; }
+            friend Cursor operator-(Cursor it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const Cursor& a, const Cursor& b) { return (difference_type)(a.pos - b.pos); }
+
+            friend bool operator==(const Cursor& a, const Cursor& b) { return a.pos == b.pos; }
+            friend bool operator!=(const Cursor& a, const Cursor& b) { return a.pos != b.pos; }
+            friend bool operator<(const Cursor& a, const Cursor& b) { return a.pos < b.pos; }
+            friend bool operator>(const Cursor& a, const Cursor& b) { return a.pos > b.pos; }
+            friend bool operator<=(const Cursor& a, const Cursor& b) { return a.pos <= b.pos; }
+            friend bool operator>=(const Cursor& a, const Cursor& b) { return a.pos >= b.pos; }
+        };
+
+        static constexpr std::size_t data_offset = (sizeof(Header) + 63) / 64 * 64;
+        static constexpr std::size_t min_records = 256;
+
+        compare_type comp;
+        Sync policy;
+        int fd;
+        std::size_t length;
+        char* base;
+
+        std::deque<Record> staged;      // a deque keeps references to the copies valid while it grows
+        std::size_t used;               // records of staged in use by the update; the rest are kept for reuse
+        std::vector<Slot> slots;
+        uint64_t epoch;
+
+        Header* header() const {
+            return reinterpret_cast<Header*>(base);
+        }
+
+        value_type* data() const {
+            return reinterpret_cast<value_type*>(base + data_offset);
+        }
+
+        static std::size_t journal_offset(size_type capacity) {
+            std::size_t end = data_offset + capacity * sizeof(value_type);
+            return (end + alignof(Record) - 1) / alignof(Record) * alignof(Record);
+        }
+
+        static std::size_t file_length(size_type capacity, std::size_t records) {
+            long page = sysconf(_SC_PAGESIZE);
+            std::size_t bytes = journal_offset(capacity) + records * sizeof(Record);
+            return (bytes + page - 1) / page * page;
+        }
+
+        Record* journal() const {
+            return reinterpret_cast<Record*>(base + journal_offset(header()->capacity));
+        }
+
+        std::size_t journal_size() const {
+            return (length - journal_offset(header()->capacity)) / sizeof(Record);
+        }
+
+        static void check(bool ok, const char* what) {
+            if (not ok)
+                throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        void map(std::size_t new_length) {
+            check(0 == ftruncate(fd, (off_t)new_length), "ftruncate");
+
+            void* p;
+
+            if (base) {
+#ifdef MREMAP_MAYMOVE
+                p = mremap(base, length, new_length, MREMAP_MAYMOVE);
+#else
+                munmap(base, length);
+                p = mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+#endif
+            } else
+                p = mmap(nullptr, new_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            check(p != MAP_FAILED, "mmap");
+            base = static_cast<char*>(p);
+            length = new_length;
+        }
+
+        static std::size_t slot_of(uint64_t index, std::size_t mask) {
+            return (std::size_t)((index * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+        }
+
+        // Start a new update: no slot is staged.  The epoch is 64 bits wide, so it never wraps.
+        void begin_update() {
+            used = 0;
+            epoch++;
+        }
+
+        // Index every staged record again in a table twice the size.
+        void grow_slots() {
+            std::vector<Slot> grown(2 * slots.size(), Slot {nullptr, 0});
+            std::size_t mask = grown.size() - 1;
+
+            for (std::size_t r = 0; r < used; r++) {
+                std::size_t i = slot_of(staged[r].index, mask);
+
+                while (grown[i].epoch == epoch)
+                    i = (i + 1) & mask;
+
+                grown[i] = Slot {&staged[r], epoch};
+            }
+
+            slots.swap(grown);
+        }
+
+        // The update's copy of slot `index`, made on first use.
+        value_type& stage(uint64_t index) {
+            std::size_t mask = slots.size() - 1;
+            std::size_t i = slot_of(index, mask);
+
+            for (; slots[i].epoch == epoch; i = (i + 1) & mask)
+                if (slots[i].record->index == index)
+                    return slots[i].record->value;
+
+            if (used == staged.size())
+                staged.emplace_back();
+
+            Record& r = staged[used++];
+            r.index = index;
+            r.value = data()[index];
+
+            if (2 * used > slots.size())
+                grow_slots();
+            else
+                slots[i] = Slot {&r, epoch};
+
+            return r.value;
+        }
+
+        // Write `bytes` bytes of the mapping from `offset` back to the file; msync wants a page-aligned start.
+        void flush(std::size_t offset, std::size_t bytes) {
+            std::size_t first = offset / (std::size_t)sysconf(_SC_PAGESIZE) * (std::size_t)sysconf(_SC_PAGESIZE);
+            check(0 == msync(base + first, offset + bytes - first, MS_SYNC), "msync");
+        }
+
+        // Apply a committed journal to the array.  Repeating it after a crash is harmless.
+        void replay() {
+            Header* h = header();
+            const Record* log = journal();
+
+            for (uint64_t r = 0; r < h->records; r++)
+                data()[log[r].index] = log[r].value;
+
+            h->size = h->next_size;
+            h->code = h->next_code;
+
+            // The array must be on disk before the journal is released.
+            if (Sync::always == policy)
+                sync();
+
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            h->committed = 0;
+
+            if (Sync::always == policy)
+                flush(0, sizeof(Header));
+        }
+
+        // Journal the staged slots, commit, then apply.
+        void commit(uint64_t new_size, HeapCode new_code) {
+            if (used > journal_size())
+                map(file_length(header()->capacity, std::max(2 * journal_size(), used)));
+
+            Header* h = header();
+            Record* log = journal();
+
+            // Slots read but left unchanged are logged too; replaying them is harmless.
+            for (std::size_t r = 0; r < used; r++)
+                log[r] = staged[r];
+
+            h->records = used;
+            h->next_size = new_size;
+            h->next_code = new_code;
+
+            // The kernel writes pages back in any order, so under Sync::always the
+            // journal reaches the disk before the commit mark, and the mark before the array.
+            if (Sync::always == policy) {
+                flush(journal_offset(h->capacity), used * sizeof(Record));
+                flush(0, sizeof(Header));
+            }
+
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            h->committed = 1;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+
+            if (Sync::always == policy)
+                flush(0, sizeof(Header));
+
+            replay();
+        }
+
+        public:
+
+        explicit MappedHeap(const char* path, const compare_type& cmp = Compare(), Sync sync_policy = Sync::on_close)
+            : comp(cmp), policy(sync_policy), fd(-1), length(0), base(nullptr), used(0), slots(64, Slot {nullptr, 0}), epoch(0) {
+            fd = open(path, O_RDWR | O_CREAT, 0644);
+            check(fd >= 0, "open");
+
+            // The destructor does not run for a constructor that throws.
+            try {
+                struct stat st;
+                check(0 == fstat(fd, &st), "fstat");
+
+                if (0 == st.st_size) {
+                    map(file_length(0, min_records));
+
+                    Header* h = header();
+                    h->magic = MAGIC;
+                    h->element_size = sizeof(value_type);
+                    h->size = 0;
+                    h->capacity = 0;
+                    h->committed = 0;
+                    h->records = 0;
+                    h->code = HeapCode{0LL, 1};
+                    return;
+                }
+
+                // Too short for a header: not a heap file, and not ours to overwrite.
+                if ((std::size_t)st.st_size < data_offset) {
+                    errno = EINVAL;
+                    check(false, path);
+                }
+
+                map((std::size_t)st.st_size);
+
+                Header* h = header();
+
+                if (MAGIC != h->magic or sizeof(value_type) != h->element_size or h->size > h->capacity
+                    or journal_offset(h->capacity) > length or (h->committed and (h->records > journal_size() or h->next_size > h->capacity))) {
+                    errno = EINVAL;
+                    check(false, path);
+                }
+
+                if (h->committed)
+                    replay();
+            } catch (...) {
+                if (base)
+                    munmap(base, length);
+
+                ::close(fd);
+                throw;
+            }
+        }
+
+        MappedHeap(const MappedHeap&) = delete;
+
+        MappedHeap& operator=(const MappedHeap&) = delete;
+
+        // A failed msync cannot be reported from here; call sync() before closing to see it.
+        ~MappedHeap() {
+            if (Sync::never != policy) {
+                try {
+                    sync();
+                } catch (const std::system_error&) {
+                }
+            }
+
+            munmap(base, length);
+            ::close(fd);
+        }
+
+        void push(const value_type& value) {
+            uint64_t n = header()->size;
+
+            if (n == header()->capacity)
+                reserve(n ? 2 * n : 1);
+
+            begin_update();
+            stage(n) = value;
+            commit(n + 1, Leonardo::push_heap(Cursor(this, n), header()->code, comp));
+        }
+
+        void pop() {
+            uint64_t n = header()->size;
+
+            begin_update();
+            commit(n - 1, Leonardo::pop_heap(Cursor(this, n - 1), header()->code, comp));
+        }
+
+        // Grow the array; only between updates, when the journal after it holds nothing.
+        void reserve(size_type n) {
+            if (n > header()->capacity) {
+                map(file_length(n, std::max(journal_size(), min_records)));
+                header()->capacity = n;
+            }
+        }
+
+        // Flush the mapping to the file; blocks until the pages are written.
+        void sync() {
+            check(0 == msync(base, length, MS_SYNC), "msync");
+        }
+
+        const value_type& top() const {
+            return data()[header()->size - 1];
+        }
+
+        bool empty() const {
+            return 0 == header()->size;
+        }
+
+        size_type size() const {
+            return header()->size;
+        }
+
+        size_type capacity() const {
+            return header()->capacity;
+        }
+    };
+}
+
+#endif
@@ -1,13 +1,168 @@
 #ifndef RELAXEDLEONARDOHEAP_HPP
+#define RELAXEDLEONARDOHEAP_HPP
 
+#include <algorithm>
 #include <memory>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#include "LeonardoHeap.hpp"
 
 namespace Leonardo {
-    template <class T, class Compare=std::less<T>>
-    class RelaxedHeap {
+    /*
+     * Slab allocator for nodes of a single type.  Nodes freed by deallocate()
+     * are recycled by the next allocate(); release() hands every slab back to
+     * the allocator at once, without touching the nodes.
+     */
+    template <class Node, class Allocator = std::allocator<Node>>
+    class NodePool {
+        union Slot {
+            Slot* next;
+            std::size_t size;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<Slot> slot_allocator;
+        typedef std::allocator_traits<slot_allocator> slot_traits;
+
+        // Every slab starts with two header slots: the link to the previous slab and its size.
+        static constexpr std::size_t HEADER = 2;
+        static constexpr std::size_t MIN_SLAB = 32;
+        static constexpr std::size_t MAX_SLAB = 65536;
+
+        slot_allocator alloc;
+        Slot* slabs = nullptr;
+        Slot* free_list = nullptr;
+        Slot* free_tail = nullptr;
+        Slot* cursor = nullptr;
+        Slot* end = nullptr;
+        std::size_t next_size = MIN_SLAB;
+
+        public:
+
+        NodePool(const Allocator& a = Allocator()) : alloc(a) {}
+
+        NodePool(const NodePool&) = delete;
+
+        NodePool& operator=(const NodePool&) = delete;
+
+        NodePool(NodePool&& other) noexcept : alloc(std::move(other.alloc)), slabs(other.slabs),
+            free_list(other.free_list), free_tail(other.free_tail), cursor(other.cursor), end(other.end), next_size(other.next_size) {
+            other.slabs = other.free_list = other.free_tail = other.cursor = other.end = nullptr;
+            other.next_size = MIN_SLAB;
+        }
+
+        NodePool& operator=(NodePool&& other) noexcept {
+            if (this != &other) {
+                release();
+                alloc = std::move(other.alloc);
+                std::swap(slabs, other.slabs);
+                std::swap(free_list, other.free_list);
+                std::swap(free_tail, other.free_tail);
+                std::swap(cursor, other.cursor);
+                std::swap(end, other.end);
+                std::swap(next_size, other.next_size);
+            }
+
+            return *this;
+        }
+
+        ~NodePool() { release(); }
+
+        Node* allocate() {
+            Slot* slot;
+
+            if (free_list) {
+                slot = free_list;
+                free_list = free_list->next;
+
+                if (not free_list)
+                    free_tail = nullptr;
+            } else {
+                if (cursor == end) {
+                    Slot* slab = slot_traits::allocate(alloc, next_size + HEADER);
+                    slab[0].next = slabs;
+                    slab[1].size = next_size + HEADER;
+                    slabs = slab;
+
+                    cursor = slab + HEADER;
+                    end = slab + next_size + HEADER;
+
+                    if (next_size < MAX_SLAB)
+                        next_size *= 2;
+                }
+
+                slot = cursor++;
+            }
+
+            return reinterpret_cast<Node*>(slot->storage);
+        }
+
+        void deallocate(Node* node) {
+            Slot* slot = reinterpret_cast<Slot*>(node);
+            if (not free_list)
+                free_tail = slot;
+
+            slot->next = free_list;
+            free_list = slot;
+        }
+
+        /*
+         * Take over the slabs and free nodes of `other`, whose allocator must
+         * compare equal.  The unused tail of its current slab is only
+         * reclaimed by release().
+         */
+        void splice(NodePool& other) {
+            if (other.slabs) {
+                Slot* last = other.slabs;
+
+                while (last[0].next)
+                    last = last[0].next;
+
+                last[0].next = slabs;
+                slabs = other.slabs;
+            }
+
+            if (other.free_list) {
+                other.free_tail->next = free_list;
+
+                if (not free_list)
+                    free_tail = other.free_tail;
+
+                free_list = other.free_list;
+            }
+
+            other.slabs = other.free_list = other.free_tail = other.cursor = other.end = nullptr;
+            other.next_size = MIN_SLAB;
+        }
+
+        void release() {
+            while (slabs) {
+                Slot* slab = slabs;
+                slabs = slab[0].next;
+                slot_traits::deallocate(alloc, slab, slab[1].size);
+            }
+
+            free_list = free_tail = cursor = end = nullptr;
+            next_size = MIN_SLAB;
+        }
+    };
+
+    /*
+     * Node-based Leonardo heap with lazy repair through marks.  Stats is a
+     * statistics policy as for Heap; HeapStats also counts marks and sweeps.
+     */
+    template <class T, class Compare=std::less<T>, class Allocator=std::allocator<T>, class Stats=NullStats>
+    class RelaxedHeap : private Stats {
         public:
             typedef T value_type;
             typedef Compare compare_type;
+            typedef Allocator allocator_type;
+            typedef Stats stats_type;
 
         private:
         struct Node {
@@ -16,31 +171,36 @@ namespace Leonardo {
             int order;
             bool marked;
 
-            std::unique_ptr<Node> left, right;
-            std::unique_ptr<Node> next;
+            Node *left, *right;
+            Node *next;
 
-            Node* get_proper_sub_node(const compare_type comp = compare_type()) {
+            template <class Comp>
+            Node* get_proper_sub_node(const Comp& comp) {
                 if (comp(left->value, right->value))
-                    return right.get();
+                    return right;
                 else
-                    return left.get();
+                    return left;
             }
 
-            void semi_mark_sweep(const compare_type& comp = compare_type()) {
-                for (Node* it = this;;) {
+            template <class Comp>
+            void semi_mark_sweep(const Comp& comp, Stats& stats) {
+                int steps = 0;
+
+                for (Node* it = this;; steps++) {
                     if (it->order > 1) {
                         Node *child = it->get_proper_sub_node(comp);
 
                         if (comp(it->value, child->value)) {
                             std::swap(it->value, child->value);
+                            stats.swap();
                             child->marked = it->marked;
                             it->marked = false;
-                            
+
                             if (child->order > 1) {
                                 if (child->left->marked)
-                                    it = child->left.get();
+                                    it = child->left;
                                 else if (child->right->marked)
-                                    it = child->right.get();
+                                    it = child->right;
                                 else
                                     break;
                             } else {
@@ -56,104 +216,372 @@ namespace Leonardo {
                         break;
                     }
                 }
+
+                stats.sweep(steps);
             }
 
-            void mark_sweep(const compare_type& comp = compare_type()) {
+            template <class Comp>
+            void mark_sweep(const Comp& comp, Stats& stats) {
                 if (left->marked)
-                    left->semi_mark_sweep(comp);
+                    left->semi_mark_sweep(comp, stats);
                 else if (right->marked)
-                    right->semi_mark_sweep(comp);
+                    right->semi_mark_sweep(comp, stats);
 
-                semi_mark_sweep(comp);
+                semi_mark_sweep(comp, stats);
             }
         };
 
         compare_type comp;
-        std::unique_ptr<Node> root;
+        NodePool<Node, Allocator> pool;
+        Node* root;
 
-        public:
+        // The policy is a private base, so an empty one such as NullStats takes no space.
+        Stats& stats() { return *this; }
+        const Stats& stats() const { return *this; }
 
-        RelaxedHeap (const compare_type& cmp = Compare()) : comp(cmp), root(nullptr) {}
+        // The comparator for the repair steps, counting calls unless stats are off.
+        auto counted_comp() {
+            if constexpr (std::is_same<Stats, NullStats>::value)
+                return comp;
+            else
+                return CountingCompare<Compare, Stats> {comp, &stats()};
+        }
+
+        template <class... Args>
+        Node* create_node(Args&&... args) {
+            Node* node = pool.allocate();
+
+            try {
+                return new (node) Node {value_type(std::forward<Args>(args)...), 1, false, nullptr, nullptr, nullptr};
+            } catch (...) {
+                pool.deallocate(node);
+                throw;
+            }
+        }
 
-        void push(value_type value) {
+        void destroy_node(Node* node) {
+            node->~Node();
+            pool.deallocate(node);
+        }
+
+        // The recursion only follows left/right, so its depth is bounded by the tree order.
+        static void destroy_tree(Node* node) {
+            if (node->order > 1) {
+                destroy_tree(node->left);
+                destroy_tree(node->right);
+            }
+
+            node->~Node();
+        }
+
+        // Link a fresh single-node tree holding the new value into the forest.
+        void link(Node* tmp) {
             if (empty()) {
-                root.reset(new Node {value, 1, false, nullptr, nullptr, nullptr});
+                root = tmp;
             } else {
-                std::unique_ptr<Node> tmp {new Node {value, 1, false, nullptr, nullptr, nullptr}};
+                auto cmp = counted_comp();
 
-                if (comp(value, root->value)) {
+                if (cmp(tmp->value, root->value)) {
                     std::swap(tmp->value, root->value);
-                    
+                    stats().swap();
+
                     if (root->order > 1) {
                         root->marked = true;
-                        root->mark_sweep(comp);
+                        stats().mark();
+                        root->mark_sweep(cmp, stats());
                     }
                 }
 
-                Node* t1 = root.get();
-                Node* t2 = root->next.get();
+                Node* t1 = root;
+                Node* t2 = root->next;
 
                 if (t2 && t2->order == (t1->order + 1)) {
                     tmp->order = t2->order + 1;
-                    tmp->next = std::move(t2->next);
-                    tmp->left = std::move(root->next);
-                    tmp->right = std::move(root);
-                    root = std::move(tmp); 
+                    tmp->next = t2->next;
+                    tmp->left = t2;
+                    tmp->right = t1;
+                    t1->next = t2->next = nullptr;
+                    root = tmp;
                 } else if (1 == t1->order) {
                     tmp->order = 0;
-                    tmp->next = std::move(root);
-                    root = std::move(tmp);
+                    tmp->next = root;
+                    root = tmp;
                 } else {
                     tmp->order = 1;
-                    tmp->next = std::move(root);
-                    root = std::move(tmp); 
+                    tmp->next = root;
+                    root = tmp;
+                }
+            }
+        }
+
+        // Move the largest root value to the head of the list and repair the tree it came from.
+        template <class Comp>
+        void settle_top(const Comp& cmp) {
+            Node* tmp = root;
+
+            for (Node* it = root->next; it; it = it->next)
+                if (cmp(tmp->value, it->value))
+                    tmp = it;
+
+            if (tmp != root) {
+                std::swap(tmp->value, root->value);
+                stats().swap();
+
+                if (tmp->order > 1) {
+                    tmp->marked = true;
+                    stats().mark();
+                    tmp->mark_sweep(cmp, stats());
                 }
             }
         }
 
+        // Make `top` the root of a tree over `left` (order k + 1) and `right` (order k), whatever value it holds.
+        template <class Comp>
+        Node* join(Node* top, Node* left, Node* right, const Comp& cmp) {
+            Node* child = cmp(left->value, right->value) ? right : left;
+
+            top->order = left->order + 1;
+            top->marked = false;
+            top->left = left;
+            top->right = right;
+            top->next = left->next = right->next = nullptr;
+
+            if (cmp(top->value, child->value)) {
+                std::swap(top->value, child->value);
+                stats().swap();
+
+                if (child->order > 1) {
+                    child->marked = true;
+                    stats().mark();
+                    child->mark_sweep(cmp, stats());
+                }
+            }
+
+            return top;
+        }
+
+        /*
+         * Rebuild the root list, in any order, into one tree per order with
+         * the top at the head.  Two trees of order k become k + 1 and k - 2:
+         * one is split and the other hung under its root.  Trees of orders k
+         * and k + 1 are joined under a single-node tree, while there are any.
+         * The single nodes left over go back through link(), as pushes do.
+         * Each step repairs one path, so the cost is O(trees * log n).
+         */
+        template <class Comp>
+        void normalize(const Comp& cmp) {
+            Node* trees[number_count + 2] = {};
+            Node* spares = nullptr;
+
+            auto put = [&trees, &spares] (Node* node) {
+                Node*& list = node->order > 1 ? trees[node->order] : spares;
+                node->next = list;
+                list = node;
+            };
+
+            auto take = [] (Node*& list) {
+                Node* node = list;
+                list = node->next;
+                return node;
+            };
+
+            for (Node* it = root; it;) {
+                Node* next = it->next;
+                put(it);
+                it = next;
+            }
+
+            // Every order below k holds at most one tree.
+            for (int k = 2; k < (int)number_count;) {
+                if (trees[k] and trees[k]->next) {
+                    Node* x = take(trees[k]);
+                    Node* y = take(trees[k]);
+                    Node* l = y->left;
+                    Node* r = y->right;
+
+                    if (l->marked)
+                        l->semi_mark_sweep(cmp, stats());
+                    else if (r->marked)
+                        r->semi_mark_sweep(cmp, stats());
+
+                    put(join(y, x, l, cmp));
+                    put(r);
+                    k = std::max(2, k - 2);
+                } else if (trees[k] and trees[k + 1] and spares) {
+                    Node* right = take(trees[k]);
+                    Node* left = take(trees[k + 1]);
+
+                    put(join(take(spares), left, right, cmp));
+                } else {
+                    k++;
+                }
+            }
+
+            root = nullptr;
+
+            for (int k = (int)number_count + 1; k > 1; k--) {
+                if (trees[k]) {
+                    trees[k]->next = root;
+                    root = trees[k];
+                }
+            }
+
+            if (root)
+                settle_top(cmp);
+
+            while (spares) {
+                Node* node = take(spares);
+
+                node->order = 1;
+                node->marked = false;
+                node->next = nullptr;
+                link(node);
+            }
+        }
+
+        public:
+
+        RelaxedHeap (const compare_type& cmp = Compare(), const allocator_type& alloc = Allocator()) : comp(cmp), pool(alloc), root(nullptr) {}
+
+        RelaxedHeap(const RelaxedHeap&) = delete;
+
+        RelaxedHeap& operator=(const RelaxedHeap&) = delete;
+
+        RelaxedHeap(RelaxedHeap&& other) noexcept : Stats(std::move(other.stats())), comp(std::move(other.comp)), pool(std::move(other.pool)), root(other.root) {
+            other.root = nullptr;
+        }
+
+        RelaxedHeap& operator=(RelaxedHeap&& other) noexcept {
+            if (this != &other) {
+                clear();
+                comp = std::move(other.comp);
+                pool = std::move(other.pool);
+                root = other.root;
+                stats() = std::move(other.stats());
+                other.root = nullptr;
+            }
+
+            return *this;
+        }
+
+        ~RelaxedHeap() { clear(); }
+
+        void push(const value_type& value) {
+            link(create_node(value));
+        }
+
+        void push(value_type&& value) {
+            link(create_node(std::move(value)));
+        }
+
+        template <class... Args>
+        void emplace(Args&&... args) {
+            link(create_node(std::forward<Args>(args)...));
+        }
+
         void pop() {
+            Node* old_root = root;
+            auto cmp = counted_comp();
+
             if (root->order > 1) {
-                std::unique_ptr<Node> l = std::move(root->left);
-                std::unique_ptr<Node> r = std::move(root->right);
-                std::unique_ptr<Node> next = std::move(root->next);
+                Node* l = root->left;
+                Node* r = root->right;
+                Node* next = root->next;
 
                 if (l->marked)
-                    l->semi_mark_sweep(comp);
+                    l->semi_mark_sweep(cmp, stats());
                 else if (r->marked)
-                    r->semi_mark_sweep(comp);
+                    r->semi_mark_sweep(cmp, stats());
 
-                l->next = std::move(next);
-                r->next = std::move(l);
-                root = std::move(r);
+                l->next = next;
+                r->next = l;
+                root = r;
             } else {
-                root = std::move(root->next);
+                root = root->next;
             }
-            
+
+            destroy_node(old_root);
+
             if (empty()) return;
 
-            Node* tmp = root.get();
+            settle_top(cmp);
+        }
 
-            for (Node* it = root->next.get(); it; it = it->next.get())
-                if (comp(tmp->value, it->value))
-                    tmp = it;
+        /*
+         * Move every element of `other` into this heap.  The two root lists
+         * are joined and normalized, so the merged forest again holds one
+         * tree per order; the cost is O(log^2 n) and no element is copied.
+         */
+        void merge(RelaxedHeap&& other) {
+            if (other.empty())
+                return;
 
-            if (tmp != root.get()) {
-                std::swap(tmp->value, root->value);
+            if (empty()) {
+                std::swap(root, other.root);
+                pool.splice(other.pool);
+                return;
+            }
 
-                if (tmp->order > 1) {
-                    tmp->marked = true;
-                    tmp->mark_sweep(comp);
+            Node* tail = root;
+
+            while (tail->next)
+                tail = tail->next;
+
+            tail->next = other.root;
+            other.root = nullptr;
+            pool.splice(other.pool);
+
+            normalize(counted_comp());
+        }
+
+        // Move the top n elements (fewer if the heap runs empty) to `out`, in pop() order.
+        template <class OutputIt>
+        OutputIt pop_k(std::size_t n, OutputIt out) {
+            for (; n and not empty(); n--) {
+                *out++ = std::move(root->value);
+                pop();
+            }
+
+            return out;
+        }
+
+        template <class OutContainer>
+        void drain_into(OutContainer& out, std::size_t n) {
+            pop_k(n, std::back_inserter(out));
+        }
+
+        // Trivially destructible values are dropped together with the slabs, without visiting a node.
+        void clear() {
+            if (not std::is_trivially_destructible<value_type>::value) {
+                for (Node* it = root; it;) {
+                    Node* next = it->next;
+                    destroy_tree(it);
+                    it = next;
                 }
             }
+
+            root = nullptr;
+            pool.release();
         }
 
-        value_type top() const {
+        const value_type& top() const {
             return root->value;
         }
 
+        // Pop the top and hand it out by move; works for move-only value types.
+        value_type pop_top() {
+            value_type value = std::move(root->value);
+            pop();
+            return value;
+        }
+
         bool empty() const {
             return not root;
         }
+
+        Stats statistics() const {
+            return stats();
+        }
     };
 }
 
@@ -0,0 +1,93 @@
+#ifndef STATICLEONARDOHEAP_HPP
+#define STATICLEONARDOHEAP_HPP
+
+#include <array>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+#include "LeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * Leonardo heap of at most N elements kept in a std::array, so it never
+     * allocates.  Every member is constexpr: a heap can be filled and drained
+     * in a constant expression.  T must be default constructible.
+     */
+    template <class T, std::size_t N, class Compare=std::less<T>>
+    class StaticHeap {
+        public:
+            typedef T value_type;
+            typedef Compare compare_type;
+            typedef std::size_t size_type;
+
+        private:
+        compare_type comp;
+        std::array<value_type, N> c;
+        size_type count;
+        HeapCode code;
+
+        constexpr auto heap_end() {
+            return std::next(std::begin(c), count);
+        }
+
+        public:
+
+        constexpr explicit StaticHeap(const compare_type& cmp = Compare()) : comp(cmp), c{}, count(0), code{0LL, 1} {}
+
+        // Heapify the elements of [first, last), of which there must be at most N.
+        template <class InputIt>
+        constexpr StaticHeap(InputIt first, InputIt last, const compare_type& cmp = Compare()) : StaticHeap(cmp) {
+            for (; first != last; ++first)
+                c[count++] = *first;
+
+            code = Leonardo::make_heap(std::begin(c), heap_end(), comp);
+        }
+
+        // The heap must not be full.
+        constexpr void push(const value_type& value) {
+            c[count++] = value;
+            code = Leonardo::push_heap(std::prev(heap_end()), code, comp);
+        }
+
+        constexpr void push(value_type&& value) {
+            c[count++] = std::move(value);
+            code = Leonardo::push_heap(std::prev(heap_end()), code, comp);
+        }
+
+        template <class... Args>
+        constexpr void emplace(Args&&... args) {
+            push(value_type(std::forward<Args>(args)...));
+        }
+
+        constexpr void pop() {
+            code = Leonardo::pop_heap(std::prev(heap_end()), code, comp);
+            count--;
+
+            if constexpr (not std::is_trivially_destructible<value_type>::value)
+                c[count] = value_type();
+        }
+
+        // Pop the top and hand it out by move.
+        constexpr value_type pop_top() {
+            code = Leonardo::pop_heap(std::prev(heap_end()), code, comp);
+            return std::move(c[--count]);
+        }
+
+        // Overwrite the top with `value`; cheaper than pop() followed by push().
+        constexpr void replace_top(const value_type& value) {
+            c[count - 1] = value;
+            Leonardo::replace_heap(std::prev(heap_end()), code, comp);
+        }
+
+        constexpr const value_type& top() const { return c[count - 1]; }
+        constexpr bool empty() const { return 0 == count; }
+        constexpr bool full() const { return N == count; }
+        constexpr size_type size() const { return count; }
+        static constexpr size_type capacity() { return N; }
+    };
+}
+
+#endif
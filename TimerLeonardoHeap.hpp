@@ -0,0 +1,255 @@
+#ifndef TIMERLEONARDOHEAP_HPP
+#define TIMERLEONARDOHEAP_HPP
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "LeonardoHeap.hpp"
+
+namespace Leonardo {
+    /*
+     * Timer service on a Leonardo::Heap of (deadline, slot) entries, with the
+     * payloads kept aside as in KeyedHeap.
+     *
+     * Deadlines are rounded up to a multiple of `resolution`, so timers due
+     * close together fire in the same expire_until() pass.  cancel() leaves a
+     * tombstone in the heap, and once tombstones make up half of the entries
+     * one erase_if() sweeps them all out.  With a nonzero `horizon`, timers
+     * due more than a `horizon` wide bucket ahead wait in buckets outside the
+     * heap, and each bucket joins the heap through push_range() when time
+     * comes within a bucket of it.
+     */
+    template <class Payload, class Time = uint64_t>
+    class TimerQueue {
+        static_assert(std::is_unsigned<Time>::value, "Time must be an unsigned tick count");
+
+        public:
+            typedef Payload payload_type;
+            typedef Time time_type;
+            typedef std::size_t size_type;
+
+            // Names a scheduled timer; stale once the timer fired or was cancelled.
+            struct TimerId {
+                uint32_t slot;
+                uint32_t generation;
+            };
+
+        private:
+        struct Entry {
+            time_type deadline;
+            uint32_t slot;
+            uint32_t generation;
+        };
+
+        // The earliest deadline on top.
+        struct Later {
+            bool operator()(const Entry& a, const Entry& b) const {
+                return b.deadline < a.deadline;
+            }
+        };
+
+        struct Slot {
+            std::optional<payload_type> payload;
+            uint32_t generation = 0;
+        };
+
+        // Fewer tombstones than this are never worth a sweep.
+        static constexpr size_type compact_min = 64;
+
+        Heap<Entry, std::vector<Entry>, Later> heap;
+        std::map<time_type, std::vector<Entry>> buckets;   // keyed by deadline / horizon
+        std::vector<Slot> slots;
+        std::vector<uint32_t> free_slots;
+        std::vector<Entry> batch;
+        time_type resolution;
+        time_type horizon;
+        time_type current;
+        size_type pending;
+        size_type tombstones;
+
+        bool dead(const Entry& entry) const {
+            return slots[entry.slot].generation != entry.generation;
+        }
+
+        template <class... Args>
+        uint32_t store(Args&&... args) {
+            if (free_slots.empty()) {
+                // Entries and TimerIds hold 32-bit slots; one more would wrap onto slot 0.
+                if (slots.size() > (size_type)std::numeric_limits<uint32_t>::max())
+                    throw std::length_error("TimerQueue: more than 2^32 pending timers");
+
+                slots.emplace_back();
+                slots.back().payload.emplace(std::forward<Args>(args)...);
+                return (uint32_t)(slots.size() - 1);
+            }
+
+            uint32_t slot = free_slots.back();
+            free_slots.pop_back();
+            slots[slot].payload.emplace(std::forward<Args>(args)...);
+            return slot;
+        }
+
+        // Free a slot; bumping its generation turns any entry still naming it into a tombstone.
+        void release(uint32_t slot) {
+            slots[slot].payload.reset();
+            slots[slot].generation++;
+            free_slots.push_back(slot);
+        }
+
+        // Drop the tombstones of a bucket and return how many there were.
+        size_type prune(std::vector<Entry>& bucket) {
+            auto first = std::remove_if(std::begin(bucket), std::end(bucket), [this] (const Entry& e) { return dead(e); });
+            size_type removed = (size_type)std::distance(first, std::end(bucket));
+
+            bucket.erase(first, std::end(bucket));
+            return removed;
+        }
+
+        // Move every bucket that may hold a deadline before the end of the next bucket into the heap.
+        void admit() {
+            while (not buckets.empty() and buckets.begin()->first <= current / horizon + 1) {
+                std::vector<Entry>& bucket = buckets.begin()->second;
+
+                tombstones -= prune(bucket);
+                heap.push_range(std::begin(bucket), std::end(bucket));
+                buckets.erase(buckets.begin());
+            }
+        }
+
+        void compact() {
+            tombstones -= heap.erase_if([this] (const Entry& e) { return dead(e); });
+
+            for (auto it = std::begin(buckets); it != std::end(buckets);) {
+                tombstones -= prune(it->second);
+                it = it->second.empty() ? buckets.erase(it) : std::next(it);
+            }
+        }
+
+        public:
+
+        explicit TimerQueue(time_type resolution = 1, time_type horizon = 0, time_type start = 0)
+            : resolution(resolution), horizon(horizon), current(start), pending(0), tombstones(0) {}
+
+        // Schedule a timer whose payload is constructed from `args`.
+        template <class... Args>
+        TimerId schedule(time_type deadline, Args&&... args) {
+            if (resolution > 1)
+                deadline += (resolution - deadline % resolution) % resolution;
+
+            uint32_t slot = store(std::forward<Args>(args)...);
+            Entry entry {deadline, slot, slots[slot].generation};
+
+            if (horizon and deadline / horizon > current / horizon + 1)
+                buckets[deadline / horizon].push_back(entry);
+            else
+                heap.push(entry);
+
+            pending++;
+            return TimerId {slot, entry.generation};
+        }
+
+        // Cancel a pending timer; false if it already fired or was cancelled.
+        bool cancel(TimerId id) {
+            if (id.slot >= slots.size() or slots[id.slot].generation != id.generation)
+                return false;
+
+            release(id.slot);
+            pending--;
+            tombstones++;
+
+            if (tombstones >= compact_min and tombstones > pending)
+                compact();
+
+            return true;
+        }
+
+        /*
+         * Advance the time to `now` and call `callback(deadline, payload)` for
+         * every timer due by then, earliest first.  The due timers are taken
+         * off the heap before the first call, so callbacks may schedule and
+         * cancel timers; new ones due by `now` fire on the next call.  If a
+         * callback throws, the due timers after it go back on the heap and the
+         * exception propagates.
+         */
+        template <class Callback>
+        size_type expire_until(time_type now, Callback&& callback) {
+            if (current < now)
+                current = now;
+
+            if (horizon)
+                admit();
+
+            std::vector<Entry> due;
+            due.swap(batch);
+
+            while (not heap.empty() and not (now < heap.top().deadline))
+                due.push_back(heap.pop_top());
+
+            size_type fired = 0;
+            auto next = std::begin(due);
+
+            try {
+                while (next != std::end(due)) {
+                    const Entry& entry = *next++;
+
+                    if (dead(entry)) {
+                        tombstones--;
+                        continue;
+                    }
+
+                    payload_type payload = std::move(*slots[entry.slot].payload);
+                    release(entry.slot);
+                    pending--;
+                    fired++;
+                    callback(entry.deadline, payload);
+                }
+            } catch (...) {
+                // The timer whose callback threw counts as fired; the ones after it stay pending.
+                heap.push_range(next, std::end(due));
+                due.clear();
+                batch.swap(due);
+                throw;
+            }
+
+            due.clear();
+            batch.swap(due);
+            return fired;
+        }
+
+        // The earliest pending deadline, if any; sheds the tombstones on top of the heap on the way.
+        std::optional<time_type> next_deadline() {
+            while (not heap.empty() and dead(heap.top())) {
+                heap.pop();
+                tombstones--;
+            }
+
+            if (not heap.empty())
+                return heap.top().deadline;
+
+            for (auto& bucket : buckets) {
+                tombstones -= prune(bucket.second);
+
+                if (not bucket.second.empty())
+                    return std::min_element(std::begin(bucket.second), std::end(bucket.second), [] (const Entry& a, const Entry& b) {
+                        return a.deadline < b.deadline;
+                    })->deadline;
+            }
+
+            return std::nullopt;
+        }
+
+        time_type now() const { return current; }
+        bool empty() const { return 0 == pending; }
+        size_type size() const { return pending; }
+    };
+}
+
+#endif
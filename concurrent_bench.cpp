@@ -0,0 +1,102 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include <vector>
+#include <queue>
+#include "ConcurrentLeonardoHeap.hpp"
+
+/*
+ * Multi-threaded throughput: every thread alternates push and pop on a shared
+ * queue prefilled with PREFILL elements.  Compares Leonardo::MultiQueue against
+ * a std::priority_queue behind one std::mutex.
+ *
+ * usage: concurrent_bench [max_threads = 64]
+ */
+
+constexpr int PREFILL = 1000000;
+constexpr int OPS_PER_THREAD = 1000000;
+
+struct LockedQueue {
+    std::mutex mutex;
+    std::priority_queue<uint64_t> q;
+
+    void push(uint64_t v) {
+        std::lock_guard<std::mutex> guard(mutex);
+        q.push(v);
+    }
+
+    bool try_pop(uint64_t& v) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        if (q.empty())
+            return false;
+
+        v = q.top();
+        q.pop();
+        return true;
+    }
+};
+
+template <class Queue>
+double measure(Queue& q, int threads) {
+    std::mt19937_64 gen(42);
+
+    for (int i = 0; i < PREFILL; i++)
+        q.push(gen());
+
+    std::atomic<bool> start{false};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&q, &start, t] () {
+            std::mt19937_64 gen(t);
+            uint64_t v;
+
+            while (not start.load())
+                std::this_thread::yield();
+
+            for (int i = 0; i < OPS_PER_THREAD / 2; i++) {
+                q.push(gen());
+                q.try_pop(v);
+            }
+        });
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+
+    for (auto& w : workers)
+        w.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return (double)threads * OPS_PER_THREAD / seconds / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : 64;
+
+    std::cout << "+----------+----------------------------+----------------------------+\n";
+    std::cout << "| threads  | MultiQueue (Mops/s)        | mutex + priority_queue     |\n";
+    std::cout << "+----------+----------------------------+----------------------------+\n";
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        Leonardo::MultiQueue<uint64_t> mq(threads);
+        LockedQueue lq;
+
+        double a = measure(mq, threads);
+        double b = measure(lq, threads);
+
+        std::cout << "| " << std::left << std::setw(9) << threads
+            << "| " << std::left << std::setw(27) << a
+            << "| " << std::left << std::setw(27) << b << "|\n";
+    }
+
+    std::cout << "+----------+----------------------------+----------------------------+\n";
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <cstdlib>
+
+#include <vector>
+#include "LeonardoHeap.hpp"
+
+/*
+ * Heap construction time over `size` random ints: std::make_heap and the
+ * sequential Leonardo::make_heap against Leonardo::parallel_make_heap for
+ * 1, 2, 4, ... up to max_threads threads.
+ *
+ * usage: construct_bench [size = 2e7] [max_threads = hardware_concurrency]
+ */
+
+constexpr int TIMES = 3;
+
+std::vector<int> A;
+std::vector<int> B;
+
+template <class Build>
+double measure(Build build) {
+    double total = 0.0;
+
+    for (int i = 0; i < TIMES; i++) {
+        std::copy(std::begin(A), std::end(A), std::begin(B));
+
+        auto start = std::chrono::steady_clock::now();
+        build(std::begin(B), std::end(B));
+        auto stop = std::chrono::steady_clock::now();
+
+        total += std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+
+    return total / (double)TIMES;
+}
+
+void print_row(const std::string& name, double ms, double base) {
+    std::cout << "| " << std::left << std::setw(29) << name
+        << "| " << std::left << std::setw(14) << ms
+        << "| " << std::left << std::setw(10) << base / ms << "|\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 20000000;
+    unsigned max_threads = argc > 2 ? (unsigned)std::atoi(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::mt19937 gen(std::random_device{}());
+    A.resize(size);
+    B.resize(size);
+
+    for (auto& x : A)
+        x = (int)gen();
+
+    typedef std::vector<int>::iterator It;
+
+    std::cout << "+------------------------------+---------------+-----------+\n";
+    std::cout << "| " << std::left << std::setw(29) << (std::to_string(size) + " ints") << "| time (ms)     | speedup   |\n";
+    std::cout << "+------------------------------+---------------+-----------+\n";
+
+    double base = measure([] (It first, It last) { Leonardo::make_heap(first, last, std::less<int>()); });
+
+    print_row("std::make_heap", measure([] (It first, It last) { std::make_heap(first, last); }), base);
+    print_row("Leonardo::make_heap", base, base);
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        double ms = measure([threads] (It first, It last) {
+            Leonardo::parallel_make_heap(first, last, std::less<int>(), threads);
+        });
+
+        if (not Leonardo::is_heap(std::begin(B), std::end(B))) {
+            std::cerr << "invalid heap\n";
+            return 1;
+        }
+
+        print_row("parallel_make_heap x" + std::to_string(threads), ms, base);
+    }
+
+    std::cout << "+------------------------------+---------------+-----------+\n";
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+
+#include <vector>
+#include "LeonardoHeap.hpp"
+
+/*
+ * ns per pop over shuffled ints, draining a whole heap: std::less, which takes
+ * the branchless root scan, against a lambda doing the same comparison, which
+ * stays on the generic path.
+ *
+ * usage: kernel_bench [max_size = 1e7]
+ */
+
+constexpr int TIMES = 3;
+
+uint64_t sink = 0;
+
+template <class Compare>
+double measure(const std::vector<int>& input, Compare comp) {
+    double total = 0.0;
+
+    for (int i = 0; i < TIMES; i++) {
+        Leonardo::Heap<int, std::vector<int>, Compare> heap(comp, input);
+
+        auto start = std::chrono::steady_clock::now();
+        while (not heap.empty()) {
+            sink += heap.top();
+            heap.pop();
+        }
+        auto stop = std::chrono::steady_clock::now();
+
+        total += std::chrono::duration<double, std::nano>(stop - start).count() / (double)input.size();
+    }
+
+    return total / (double)TIMES;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 10000000;
+    std::mt19937 gen(std::random_device{}());
+
+    std::cout << "+-----------+-------------------+-------------------+\n";
+    std::cout << "| size      | std::less (ns)    | lambda (ns)       |\n";
+    std::cout << "+-----------+-------------------+-------------------+\n";
+
+    for (std::size_t size = 10000; size <= max_size; size *= 10) {
+        std::vector<int> input(size);
+        std::iota(std::begin(input), std::end(input), 0);
+        std::shuffle(std::begin(input), std::end(input), gen);
+
+        std::cout << "| " << std::left << std::setw(10) << size
+            << "| " << std::left << std::setw(18) << measure(input, std::less<int>())
+            << "| " << std::left << std::setw(18) << measure(input, [] (int a, int b) { return a < b; })
+            << "|\n";
+    }
+
+    std::cout << "+-----------+-------------------+-------------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
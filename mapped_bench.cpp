@@ -0,0 +1,123 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+#include <vector>
+#include "LeonardoHeap.hpp"
+#include "MappedLeonardoHeap.hpp"
+
+/*
+ * Restart cost of a persistent queue: reopening a Leonardo::MappedHeap file
+ * against rebuilding an in-memory Leonardo::Heap, either by replaying every
+ * push or by one make_heap pass over the saved elements.  The pop rows take
+ * a tenth of the entries off each queue, to show what the journal of
+ * MappedHeap costs per update.
+ *
+ * usage: mapped_bench [size = 1e7] [heap file = mapped_bench.heap]
+ */
+
+struct Entry {
+    uint64_t key;
+    uint64_t job;
+
+    bool operator<(const Entry& other) const { return key < other.key; }
+};
+
+typedef Leonardo::MappedHeap<Entry> MappedQueue;
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+uint64_t sink = 0;
+
+void print_row(const std::string& name, double ms) {
+    std::cout << "| " << std::left << std::setw(29) << name << "| " << std::left << std::setw(14) << ms << "|\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 10000000;
+    const char* path = argc > 2 ? argv[2] : "mapped_bench.heap";
+
+    std::mt19937_64 gen(std::random_device{}());
+    std::vector<Entry> entries(size);
+
+    for (std::size_t i = 0; i < size; i++)
+        entries[i] = Entry {gen(), i};
+
+    std::remove(path);
+
+    std::cout << "+------------------------------+---------------+\n";
+    std::cout << "| " << std::left << std::setw(29) << (std::to_string(size) + " entries") << "| time (ms)     |\n";
+    std::cout << "+------------------------------+---------------+\n";
+
+    {
+        Timer t;
+        MappedQueue q(path, std::less<Entry>(), MappedQueue::Sync::never);
+
+        q.reserve(size);
+        for (const Entry& e : entries)
+            q.push(e);
+
+        print_row("MappedHeap push", t.ms());
+
+        Timer u;
+        q.sync();
+        print_row("MappedHeap msync", u.ms());
+    }
+
+    {
+        Timer t;
+        MappedQueue q(path, std::less<Entry>(), MappedQueue::Sync::never);
+        sink += q.top().key;
+        print_row("MappedHeap reopen", t.ms());
+
+        Timer u;
+        for (std::size_t i = 0; i < size / 10; i++)
+            q.pop();
+
+        sink += q.empty() ? 0 : q.top().key;
+        print_row("MappedHeap pop size/10", u.ms());
+    }
+
+    {
+        Timer t;
+        Leonardo::Heap<Entry> q;
+
+        for (const Entry& e : entries)
+            q.push(e);
+
+        sink += q.top().key;
+        print_row("Heap replay push", t.ms());
+    }
+
+    {
+        std::vector<Entry> copy(entries);
+
+        Timer t;
+        Leonardo::Heap<Entry> q(std::less<Entry>(), std::move(copy));
+        sink += q.top().key;
+        print_row("Heap make_heap", t.ms());
+
+        Timer u;
+        for (std::size_t i = 0; i < size / 10; i++)
+            q.pop();
+
+        sink += q.empty() ? 0 : q.top().key;
+        print_row("Heap pop size/10", u.ms());
+    }
+
+    std::cout << "+------------------------------+---------------+\n";
+
+    std::remove(path);
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "MappedLeonardoHeap.hpp"
+
+/*
+ * Crash checks of Leonardo::MappedHeap.  A child process opens a heap file
+ * and dies in the middle of an update, either by _exit from the comparator
+ * after a given number of comparisons or by a SIGKILL at a random time; the
+ * parent then reopens the file and checks that it holds a valid heap whose
+ * elements are those of some prefix of the child's updates.  Also checks
+ * that a file too short for the header is rejected and left alone.
+ * Returns 1 if any check fails.
+ *
+ * usage: mapped_test [heap file = mapped_test.heap] [kills = 100]
+ */
+
+// Comparisons left before the process dies; negative for never.
+long budget = -1;
+
+struct Dying {
+    bool operator()(uint64_t a, uint64_t b) const {
+        if (budget >= 0 and budget-- == 0)
+            _exit(0);
+
+        return a < b;
+    }
+};
+
+typedef Leonardo::MappedHeap<uint64_t, Dying> DyingHeap;
+typedef Leonardo::MappedHeap<uint64_t> PlainHeap;
+
+// Pop everything, largest first.
+template <class Heap>
+std::vector<uint64_t> drain(Heap& h) {
+    std::vector<uint64_t> out;
+
+    while (not h.empty()) {
+        out.push_back(h.top());
+        h.pop();
+    }
+
+    return out;
+}
+
+int failures = 0;
+
+void report(const std::string& check, uint64_t cases, bool ok, double ms) {
+    failures += not ok;
+
+    std::cout << "| " << std::left << std::setw(39) << check
+        << "| " << std::left << std::setw(12) << cases
+        << "| " << std::left << std::setw(7) << (ok ? "ok" : "FAILED")
+        << "| " << std::left << std::setw(12) << ms << "|\n";
+}
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Op i of the SIGKILL child: pop when i % 3 == 2, else push value(i).
+uint64_t value(int i) {
+    return (uint64_t)i * 2654435761ULL % 1000003ULL;
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "mapped_test.heap";
+    int kills = argc > 2 ? std::atoi(argv[2]) : 100;
+    std::mt19937 gen(std::random_device{}());
+
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+    std::cout << "| check                                  | cases       | result | time (ms)   |\n";
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+
+        // Kill a push of 5 and the pop after it at every comparison, on heaps of every shape up to 200.
+        for (int n = 1; n <= 200 and ok; n++) {
+            for (long k = 0; ok; k++) {
+                std::remove(path.c_str());
+
+                std::vector<uint64_t> expect;
+                {
+                    DyingHeap h(path.c_str());
+
+                    for (int i = 0; i < n; i++) {
+                        expect.push_back(10 * (uint64_t)(i * 7919 % n + 1));
+                        h.push(expect.back());
+                    }
+                }
+
+                pid_t pid = fork();
+
+                if (0 == pid) {
+                    DyingHeap h(path.c_str(), Dying(), DyingHeap::Sync::never);
+                    budget = k;
+                    h.push(5);
+                    budget = -1;
+                    h.pop();
+                    _exit(1);
+                }
+
+                int status;
+                waitpid(pid, &status, 0);
+
+                // Both updates finished before the budget ran out.
+                if (1 == WEXITSTATUS(status))
+                    break;
+
+                cases++;
+
+                DyingHeap h(path.c_str());
+                std::vector<uint64_t> got = drain(h);
+
+                // The 5 is there if the push committed, and gone again if the pop did too.
+                got.erase(std::remove(std::begin(got), std::end(got), 5), std::end(got));
+                std::sort(std::begin(expect), std::end(expect), std::greater<uint64_t>());
+                ok = got == expect;
+            }
+        }
+
+        report("_exit from the comparator", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+        const int ops = 400000;
+
+        for (int trial = 0; trial < kills and ok; trial++) {
+            std::remove(path.c_str());
+
+            pid_t pid = fork();
+
+            if (0 == pid) {
+                PlainHeap h(path.c_str(), std::less<uint64_t>(), PlainHeap::Sync::never);
+
+                for (int i = 0; i < ops; i++) {
+                    if (i % 3 == 2)
+                        h.pop();
+                    else
+                        h.push(value(i));
+                }
+
+                _exit(0);
+            }
+
+            struct timespec delay {0, (long)(gen() % 150000000)};
+            nanosleep(&delay, nullptr);
+            kill(pid, SIGKILL);
+
+            int status;
+            waitpid(pid, &status, 0);
+
+            if (not WIFSIGNALED(status))
+                continue;
+
+            cases++;
+
+            PlainHeap h(path.c_str());
+            std::vector<uint64_t> got = drain(h);
+
+            // Pops come out largest first; then look for the prefix of ops that leaves this multiset.
+            ok = std::is_sorted(got.rbegin(), got.rend());
+            std::sort(std::begin(got), std::end(got));
+
+            std::multiset<uint64_t> ref;
+            bool found = got.empty();
+
+            for (int i = 0; i < ops and ok and not found; i++) {
+                if (i % 3 == 2)
+                    ref.erase(std::prev(std::end(ref)));
+                else
+                    ref.insert(value(i));
+
+                found = ref.size() == got.size() and std::equal(std::begin(ref), std::end(ref), std::begin(got));
+            }
+
+            ok = ok and found;
+        }
+
+        report("SIGKILL at a random time", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = false;
+
+        std::remove(path.c_str());
+        {
+            std::ofstream f(path);
+            f << "hello";
+        }
+
+        try {
+            PlainHeap h(path.c_str());
+        } catch (const std::system_error& e) {
+            ok = EINVAL == e.code().value();
+        }
+
+        std::ifstream f(path);
+        std::string content;
+        f >> content;
+        ok = ok and "hello" == content;
+
+        report("short file rejected and kept", 1, ok, t.ms());
+    }
+
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+
+    std::remove(path.c_str());
+
+    return failures ? 1 : 0;
+}
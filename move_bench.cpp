@@ -0,0 +1,145 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include "LeonardoHeap.hpp"
+#include "RelaxedLeonardoHeap.hpp"
+
+/*
+ * Copies and moves of the payload per element pushed and popped, with the
+ * copying calls (push an lvalue, copy top() out, then pop()) against emplace()
+ * and pop_top(), for a 256-byte payload and one that owns 256 bytes on the
+ * heap.  The moves include the ones the heaps make while sifting.
+ *
+ * usage: move_bench [size = 1e5]
+ */
+
+uint64_t sink = 0;
+
+// Counts every copy and move of the payloads derived from it.
+struct Tally {
+    static uint64_t copies, moves;
+
+    Tally() = default;
+    Tally(const Tally&) { copies++; }
+    Tally(Tally&&) noexcept { moves++; }
+    Tally& operator=(const Tally&) { copies++; return *this; }
+    Tally& operator=(Tally&&) noexcept { moves++; return *this; }
+};
+
+uint64_t Tally::copies = 0;
+uint64_t Tally::moves = 0;
+
+struct Blob : Tally {
+    uint64_t key;
+    char payload[256 - sizeof(uint64_t)];
+
+    explicit Blob(uint64_t k) : key(k) {}
+
+    bool operator<(const Blob& other) const { return key < other.key; }
+};
+
+struct Owned : Tally {
+    uint64_t key;
+    std::vector<char> payload;
+
+    explicit Owned(uint64_t k) : key(k), payload(256) {}
+
+    bool operator<(const Owned& other) const { return key < other.key; }
+};
+
+struct Result {
+    double copies;
+    double moves;
+    double ns;
+};
+
+template <class Queue, class T>
+Result copying(const std::vector<uint64_t>& keys) {
+    std::vector<T> values;
+    values.reserve(keys.size());
+    for (uint64_t k : keys)
+        values.emplace_back(k);
+
+    Queue q;
+    Tally::copies = Tally::moves = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const T& v : values)
+        q.push(v);
+
+    while (not q.empty()) {
+        T v = q.top();
+        q.pop();
+        sink += v.key;
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double n = (double)keys.size();
+    return {(double)Tally::copies / n, (double)Tally::moves / n, std::chrono::duration<double, std::nano>(stop - start).count() / n};
+}
+
+template <class Queue, class T>
+Result moving(const std::vector<uint64_t>& keys) {
+    Queue q;
+    Tally::copies = Tally::moves = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        q.emplace(k);
+
+    while (not q.empty()) {
+        T v = q.pop_top();
+        sink += v.key;
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double n = (double)keys.size();
+    return {(double)Tally::copies / n, (double)Tally::moves / n, std::chrono::duration<double, std::nano>(stop - start).count() / n};
+}
+
+void print_row(const std::string& name, const char* payload, const char* api, const Result& r) {
+    std::cout << "| " << std::left << std::setw(21) << name
+        << "| " << std::left << std::setw(10) << payload
+        << "| " << std::left << std::setw(16) << api
+        << "| " << std::left << std::setw(10) << r.copies
+        << "| " << std::left << std::setw(10) << r.moves
+        << "| " << std::left << std::setw(10) << r.ns << "|\n";
+}
+
+template <class T>
+void run(const char* payload, const std::vector<uint64_t>& keys) {
+    typedef Leonardo::Heap<T> Heap;
+    typedef Leonardo::RelaxedHeap<T> RelaxedHeap;
+
+    print_row("Leonardo Heap", payload, "push/top/pop", copying<Heap, T>(keys));
+    print_row("Leonardo Heap", payload, "emplace/pop_top", moving<Heap, T>(keys));
+    print_row("Relaxed Leonardo Heap", payload, "push/top/pop", copying<RelaxedHeap, T>(keys));
+    print_row("Relaxed Leonardo Heap", payload, "emplace/pop_top", moving<RelaxedHeap, T>(keys));
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 100000;
+    std::mt19937_64 gen(std::random_device{}());
+
+    std::vector<uint64_t> keys(size);
+    for (auto& k : keys)
+        k = gen();
+
+    std::cout << "+----------------------+-----------+-----------------+-----------+-----------+-----------+\n";
+    std::cout << "| queue                | payload   | calls           | copies    | moves     | ns        |\n";
+    std::cout << "+----------------------+-----------+-----------------+-----------+-----------+-----------+\n";
+
+    run<Blob>("256 bytes", keys);
+    run<Owned>("owning", keys);
+
+    std::cout << "+----------------------+-----------+-----------------+-----------+-----------+-----------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include "LeonardoHeap.hpp"
+
+/*
+ * Reading the K largest elements of a heap and leaving it as it was: copying
+ * the heap and popping K times against Heap::top_k, which walks the trees
+ * from their roots.  µs per read, averaged over `TIMES` reads.
+ *
+ * usage: peek_bench [max_size = 1e7] [K = 100]
+ */
+
+constexpr int TIMES = 20;
+
+uint64_t sink = 0;
+
+template <class Read>
+double measure(Read read) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < TIMES; i++)
+        read();
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(stop - start).count() / (double)TIMES;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 10000000;
+    std::size_t k = argc > 2 ? (std::size_t)std::atof(argv[2]) : 100;
+    std::mt19937_64 gen(std::random_device{}());
+
+    std::cout << "+-----------+-------------------+-------------------+\n";
+    std::cout << "| size      | copy + pop (us)   | top_k (us)        |\n";
+    std::cout << "+-----------+-------------------+-------------------+\n";
+
+    for (std::size_t size = 10000; size <= max_size; size *= 10) {
+        std::vector<uint64_t> keys(size);
+        for (auto& x : keys)
+            x = gen();
+
+        Leonardo::Heap<uint64_t> heap(std::less<uint64_t>(), std::move(keys));
+        std::vector<uint64_t> out;
+        out.reserve(k);
+
+        double copy_us = measure([&] {
+            Leonardo::Heap<uint64_t> copy(heap);
+            out.clear();
+            copy.pop_k(k, std::back_inserter(out));
+            sink += out.back();
+        });
+
+        double view_us = measure([&] {
+            out.clear();
+            heap.top_k(k, std::back_inserter(out));
+            sink += out.back();
+        });
+
+        std::cout << "| " << std::left << std::setw(10) << size
+            << "| " << std::left << std::setw(18) << copy_us
+            << "| " << std::left << std::setw(18) << view_us << "|\n";
+    }
+
+    std::cout << "+-----------+-------------------+-------------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
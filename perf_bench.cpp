@@ -0,0 +1,307 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <string>
+#include <array>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include <queue>
+#include "LeonardoHeap.hpp"
+#include "RelaxedLeonardoHeap.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+ * Hardware counters per operation for the push, pop and construct phases of
+ * std::priority_queue, Leonardo::Heap and Leonardo::RelaxedHeap, next to the
+ * comparisons per operation that test_bench.cpp reports.  The counters come
+ * from one perf_event_open group around each phase.  Events the machine does
+ * not have are shown as n/a, and without any counters (no PMU,
+ * perf_event_paranoid too high) only comparisons and wall-clock time are left.
+ * Comparisons are counted in a separate run, so the counting comparator does
+ * not show up in the hardware figures.
+ *
+ * usage: perf_bench [size = 1e6]
+ */
+
+uint64_t sink = 0;
+
+constexpr int EVENTS = 6;
+
+const char* const event_names[EVENTS] = {
+    "cycles", "instr", "L1d miss", "LLC miss", "br miss", "dTLB miss"
+};
+
+typedef std::array<double, EVENTS> Counters;
+
+class PerfGroup {
+    int fds[EVENTS];
+    int leader = -1;
+    int opened = 0;
+    int slot[EVENTS];   // position of each event in the group read, or -1
+    std::string reason;
+
+    static perf_event_attr attr_of(int event) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+
+        auto cache = [] (uint64_t cache_id) {
+            return cache_id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+
+        switch (event) {
+            case 0: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case 1: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case 2: attr.type = PERF_TYPE_HW_CACHE; attr.config = cache(PERF_COUNT_HW_CACHE_L1D); break;
+            case 3: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case 4: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            default: attr.type = PERF_TYPE_HW_CACHE; attr.config = cache(PERF_COUNT_HW_CACHE_DTLB); break;
+        }
+
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return attr;
+    }
+
+    public:
+
+    PerfGroup() {
+        for (int i = 0; i < EVENTS; i++) {
+            perf_event_attr attr = attr_of(i);
+            fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+            slot[i] = -1;
+
+            if (fds[i] < 0) {
+                if (reason.empty())
+                    reason = std::string(event_names[i]) + ": " + std::strerror(errno);
+                continue;
+            }
+
+            if (leader < 0)
+                leader = fds[i];
+
+            slot[i] = opened++;
+        }
+    }
+
+    PerfGroup(const PerfGroup&) = delete;
+    PerfGroup& operator=(const PerfGroup&) = delete;
+
+    ~PerfGroup() {
+        for (int fd : fds)
+            if (fd >= 0)
+                close(fd);
+    }
+
+    bool available() const { return leader >= 0; }
+
+    // Why the first missing event could not be opened, empty if all were.
+    const std::string& error() const { return reason; }
+
+    void start() {
+        if (available()) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    // Stop counting and return the totals, scaled up if the group was multiplexed; NaN where missing.
+    Counters stop() {
+        Counters out;
+        out.fill(NAN);
+
+        if (not available())
+            return out;
+
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        uint64_t buffer[3 + EVENTS];
+        if (read(leader, buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t)) or 0 == buffer[2])
+            return out;
+
+        double scale = (double)buffer[1] / (double)buffer[2];
+
+        for (int i = 0; i < EVENTS; i++)
+            if (slot[i] >= 0 and (uint64_t)slot[i] < buffer[0])
+                out[i] = (double)buffer[3 + slot[i]] * scale;
+
+        return out;
+    }
+};
+
+struct Sample {
+    double comparisons = NAN;
+    double ns = 0.0;
+    Counters counters;
+};
+
+typedef std::less<uint32_t> Less;
+typedef Leonardo::CountingCompare<Less, Leonardo::HeapStats> CountingLess;
+
+template <class Compare> using PriorityQueue = std::priority_queue<uint32_t, std::vector<uint32_t>, Compare>;
+template <class Compare> using LeonardoHeap = Leonardo::Heap<uint32_t, std::vector<uint32_t>, Compare>;
+template <class Compare> using RelaxedHeap = Leonardo::RelaxedHeap<uint32_t, Compare>;
+
+// Run `body` once under the counters; the counts are per operation.
+template <class Body>
+Sample measure(PerfGroup& perf, std::size_t ops, Body body) {
+    Sample sample;
+
+    perf.start();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto stop = std::chrono::steady_clock::now();
+    sample.counters = perf.stop();
+
+    sample.ns = std::chrono::duration<double, std::nano>(stop - start).count() / (double)ops;
+    for (double& x : sample.counters)
+        x /= (double)ops;
+
+    return sample;
+}
+
+template <class Queue>
+void push_all(Queue& q, const std::vector<uint32_t>& keys) {
+    for (uint32_t x : keys)
+        q.push(x);
+}
+
+template <class Queue>
+void pop_all(Queue& q) {
+    while (not q.empty()) {
+        sink += q.top();
+        q.pop();
+    }
+}
+
+template <template <class> class Queue>
+Sample push_phase(PerfGroup& perf, const std::vector<uint32_t>& keys) {
+    Leonardo::HeapStats stats;
+    {
+        Queue<CountingLess> q(CountingLess {Less(), &stats});
+        push_all(q, keys);
+    }
+
+    Queue<Less> q;
+    Sample sample = measure(perf, keys.size(), [&] { push_all(q, keys); });
+    sample.comparisons = (double)stats.comparisons / (double)keys.size();
+    return sample;
+}
+
+template <template <class> class Queue>
+Sample pop_phase(PerfGroup& perf, const std::vector<uint32_t>& keys) {
+    Leonardo::HeapStats stats;
+    {
+        Queue<CountingLess> q(CountingLess {Less(), &stats});
+        push_all(q, keys);
+        stats.comparisons = 0;
+        pop_all(q);
+    }
+
+    Queue<Less> q;
+    push_all(q, keys);
+    Sample sample = measure(perf, keys.size(), [&] { pop_all(q); });
+    sample.comparisons = (double)stats.comparisons / (double)keys.size();
+    return sample;
+}
+
+// Construction from a whole container; RelaxedHeap has no such constructor.
+template <template <class> class Queue>
+Sample construct_phase(PerfGroup& perf, const std::vector<uint32_t>& keys) {
+    Leonardo::HeapStats stats;
+    {
+        Queue<CountingLess> q(CountingLess {Less(), &stats}, keys);
+        sink += q.top();
+    }
+
+    Sample sample = measure(perf, keys.size(), [&] {
+        Queue<Less> q(Less(), keys);
+        sink += q.top();
+    });
+    sample.comparisons = (double)stats.comparisons / (double)keys.size();
+    return sample;
+}
+
+void print_cell(double x) {
+    if (std::isnan(x))
+        std::cout << "| " << std::left << std::setw(10) << "n/a";
+    else
+        std::cout << "| " << std::left << std::setw(10) << std::setprecision(4) << x;
+}
+
+void print_line() {
+    std::cout << "+----------------------+-----------+";
+    for (int i = 0; i < EVENTS + 2; i++)
+        std::cout << "-----------+";
+    std::cout << "\n";
+}
+
+void print_row(const std::string& name, const char* phase, const Sample& sample) {
+    std::cout << "| " << std::left << std::setw(21) << name << "| " << std::left << std::setw(10) << phase;
+    print_cell(sample.comparisons);
+    print_cell(sample.ns);
+    for (double x : sample.counters)
+        print_cell(x);
+    std::cout << "|\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 1000000;
+    std::mt19937 gen(std::random_device{}());
+    PerfGroup perf;
+
+    if (not perf.available())
+        std::cout << "hardware counters unavailable (" << perf.error() << "): no PMU, or perf_event_paranoid is too high\n";
+    else if (not perf.error().empty())
+        std::cout << "some counters unavailable (" << perf.error() << ")\n";
+
+    std::vector<uint32_t> ascending(size), random(size), descending(size);
+    std::iota(std::begin(ascending), std::end(ascending), 0);
+    std::copy(std::rbegin(ascending), std::rend(ascending), std::begin(descending));
+    for (auto& x : random)
+        x = (uint32_t)gen();
+
+    const std::pair<const char*, const std::vector<uint32_t>*> inputs[] = {
+        {"ascending", &ascending}, {"random", &random}, {"descending", &descending}
+    };
+
+    for (const auto& input : inputs) {
+        const std::vector<uint32_t>& keys = *input.second;
+
+        print_line();
+        std::cout << "| " << std::left << std::setw(21) << (std::string(input.first) + " input") << "| per op    ";
+        std::cout << "| cmp       | ns        ";
+        for (const char* name : event_names)
+            std::cout << "| " << std::left << std::setw(10) << name;
+        std::cout << "|\n";
+        print_line();
+
+        print_row("std priority queue", "push", push_phase<PriorityQueue>(perf, keys));
+        print_row("std priority queue", "pop", pop_phase<PriorityQueue>(perf, keys));
+        print_row("std priority queue", "construct", construct_phase<PriorityQueue>(perf, keys));
+        print_row("Leonardo Heap", "push", push_phase<LeonardoHeap>(perf, keys));
+        print_row("Leonardo Heap", "pop", pop_phase<LeonardoHeap>(perf, keys));
+        print_row("Leonardo Heap", "construct", construct_phase<LeonardoHeap>(perf, keys));
+        print_row("Relaxed Leonardo Heap", "push", push_phase<RelaxedHeap>(perf, keys));
+        print_row("Relaxed Leonardo Heap", "pop", pop_phase<RelaxedHeap>(perf, keys));
+    }
+
+    print_line();
+
+    return sink == 42 ? 1 : 0;
+}
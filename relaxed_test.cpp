@@ -0,0 +1,317 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+#include "RelaxedLeonardoHeap.hpp"
+#include "AddressableLeonardoHeap.hpp"
+#include "IntrusiveLeonardoHeap.hpp"
+
+/*
+ * Randomized checks of the linked heaps against std::multiset and std::set.
+ * RelaxedHeap runs pushes, pops and merges of heaps of every size, including
+ * many heaps of the same shape, whose duplicate-order trees merge() has to
+ * normalize.  AddressableRelaxedHeap and IntrusiveRelaxedHeap add
+ * decrease_key, erase and unlink on random elements, and a constructor that
+ * throws inside push.  The top is compared after every step and each heap is
+ * drained at the end.  Build with -fsanitize=address,undefined to catch
+ * broken links as well.  Returns 1 if any check fails.
+ *
+ * usage: relaxed_test [rounds = 40]
+ */
+
+int failures = 0;
+
+void report(const std::string& check, uint64_t cases, bool ok, double ms) {
+    failures += not ok;
+
+    std::cout << "| " << std::left << std::setw(39) << check
+        << "| " << std::left << std::setw(12) << cases
+        << "| " << std::left << std::setw(7) << (ok ? "ok" : "FAILED")
+        << "| " << std::left << std::setw(12) << ms << "|\n";
+}
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Pop h down to empty; it must yield exactly the elements of ref, largest first.
+template <class Heap, class T>
+bool drains_to(Heap& h, std::multiset<T>& ref) {
+    bool ok = true;
+
+    while (ok and not ref.empty()) {
+        ok = not h.empty() and h.top() == *ref.rbegin();
+        h.pop();
+        ref.erase(std::prev(std::end(ref)));
+    }
+
+    return ok and h.empty();
+}
+
+// Move constructor throws for one chosen value.
+struct Fragile {
+    static int armed;
+    int value;
+
+    Fragile(int value) : value(value) {}
+    Fragile(const Fragile& other) = default;
+    Fragile(Fragile&& other) : value(other.value) {
+        if (value == armed)
+            throw value;
+    }
+
+    Fragile& operator=(Fragile&& other) = default;
+
+    bool operator<(const Fragile& other) const { return value < other.value; }
+};
+
+int Fragile::armed = -1;
+
+struct Job : Leonardo::RelaxedHook {
+    long deadline;
+    int id;
+    bool live = false;
+};
+
+// Earliest deadline on top; ids break ties so that the top is unique.
+struct Later {
+    bool operator()(const Job& a, const Job& b) const {
+        return a.deadline > b.deadline or (a.deadline == b.deadline and a.id > b.id);
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 40;
+    std::mt19937_64 gen(std::random_device{}());
+
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+    std::cout << "| check                                  | cases       | result | time (ms)   |\n";
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+
+        for (int round = 0; round < rounds and ok; round++) {
+            Leonardo::RelaxedHeap<std::string> h;
+            std::multiset<std::string> ref;
+            int ops = 2000 + gen() % 3000;
+
+            for (int i = 0; i < ops and ok; i++, cases++) {
+                unsigned r = gen() % 100;
+
+                if (r < 55) {
+                    std::string value = std::to_string(gen() % 100000);
+                    h.push(value);
+                    ref.insert(value);
+                } else if (r < 90) {
+                    if (not ref.empty()) {
+                        h.pop();
+                        ref.erase(std::prev(std::end(ref)));
+                    }
+                } else {
+                    // Mostly small heaps, sometimes one larger than h.
+                    Leonardo::RelaxedHeap<std::string> other;
+                    int m = gen() % (r < 99 ? 20 : 2000);
+
+                    for (int j = 0; j < m; j++) {
+                        std::string value = std::to_string(gen() % 100000);
+                        other.push(value);
+                        ref.insert(value);
+                    }
+
+                    h.merge(std::move(other));
+                    ok = other.empty();
+                }
+
+                ok = ok and h.empty() == ref.empty() and (ref.empty() or h.top() == *ref.rbegin());
+            }
+
+            ok = ok and drains_to(h, ref);
+        }
+
+        report("RelaxedHeap push/pop/merge", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+
+        // Heaps of 1000 elements share one shape, so every merge brings duplicate orders.
+        for (int m : {2, 3, 64, 500}) {
+            Leonardo::RelaxedHeap<int> h;
+            std::multiset<int> ref;
+
+            for (int i = 0; i < m; i++, cases++) {
+                Leonardo::RelaxedHeap<int> other;
+
+                for (int j = 0; j < 1000; j++) {
+                    int value = gen() % 1000;
+                    other.push(value);
+                    ref.insert(value);
+                }
+
+                h.merge(std::move(other));
+            }
+
+            ok = ok and drains_to(h, ref);
+        }
+
+        report("RelaxedHeap merge of equal shapes", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+
+        for (int round = 0; round < rounds and ok; round++) {
+            Leonardo::AddressableRelaxedHeap<long, std::greater<long>> h;
+            std::multiset<long> ref;
+            std::vector<Leonardo::AddressableRelaxedHeap<long, std::greater<long>>::handle_type> handles;
+
+            for (int i = 0; i < 5000 and ok; i++, cases++) {
+                unsigned r = gen() % 10;
+
+                if (r < 5 or handles.empty()) {
+                    long value = gen() % 1000000;
+                    handles.push_back(h.push(value));
+                    ref.insert(value);
+                } else {
+                    std::size_t k = gen() % handles.size();
+                    auto handle = handles[k];
+                    long value = h.value(handle);
+
+                    if (r < 7) {
+                        ref.erase(ref.find(value));
+                        value -= gen() % 1000;
+                        ref.insert(value);
+                        h.decrease_key(handle, value);
+                    } else {
+                        ref.erase(ref.find(value));
+                        h.erase(handle);
+                        handles[k] = handles.back();
+                        handles.pop_back();
+                    }
+                }
+
+                ok = h.size() == ref.size() and (ref.empty() or h.top() == *std::begin(ref));
+            }
+        }
+
+        report("AddressableRelaxedHeap vs multiset", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+
+        for (int round = 0; round < rounds and ok; round++) {
+            Leonardo::AddressableRelaxedHeap<Fragile> h;
+
+            for (int i = 0; i < 100; i++)
+                h.push(Fragile(i));
+
+            // A throwing constructor must leave the heap as it was, and no slot taken.
+            Fragile::armed = 1000;
+
+            for (int i = 0; i < 10; i++, cases++) {
+                try {
+                    h.push(Fragile(1000));
+                    ok = false;
+                } catch (int) {
+                }
+            }
+
+            Fragile::armed = -1;
+            ok = ok and h.size() == 100;
+
+            for (int expect = 99; ok and expect >= 0; expect--) {
+                ok = h.top().value == expect;
+                h.pop();
+            }
+
+            ok = ok and h.empty();
+        }
+
+        report("AddressableRelaxedHeap throwing push", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t cases = 0;
+
+        for (int round = 0; round < rounds and ok; round++) {
+            std::vector<Job> slab(3000);
+            std::set<std::pair<long, int>> ref;
+            Leonardo::IntrusiveRelaxedHeap<Job, Later> h;
+            long range = round % 2 ? 20 : 1000000;   // few distinct deadlines on odd rounds
+
+            for (int i = 0; i < 3000; i++)
+                slab[i].id = i;
+
+            for (int i = 0; i < 6000 and ok; i++, cases++) {
+                unsigned r = gen() % 10;
+                Job& job = slab[gen() % slab.size()];
+
+                if (r < 5) {
+                    if (not job.live) {
+                        job.deadline = gen() % range;
+                        job.live = true;
+                        h.push(job);
+                        ref.insert({job.deadline, job.id});
+                    }
+                } else if (r < 7) {
+                    if (not h.empty()) {
+                        Job& top = h.top();
+                        top.live = false;
+                        h.pop();
+                        ref.erase({top.deadline, top.id});
+                    }
+                } else if (r < 9) {
+                    if (job.live) {
+                        job.live = false;
+                        h.unlink(job);
+                        ref.erase({job.deadline, job.id});
+                    }
+                } else if (job.live) {
+                    ref.erase({job.deadline, job.id});
+                    h.decrease_key(job, [&] (Job& j) { j.deadline -= gen() % 50; });
+                    ref.insert({job.deadline, job.id});
+                }
+
+                ok = h.size() == ref.size() and (ref.empty() or h.top().id == std::begin(ref)->second);
+            }
+
+            while (ok and not ref.empty()) {
+                ok = h.top().id == std::begin(ref)->second;
+                h.pop();
+                ref.erase(std::begin(ref));
+            }
+
+            ok = ok and h.empty();
+        }
+
+        report("IntrusiveRelaxedHeap vs set", cases, ok, t.ms());
+    }
+
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+
+    return failures ? 1 : 0;
+}
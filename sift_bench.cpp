@@ -0,0 +1,91 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include <queue>
+#include "LeonardoHeap.hpp"
+
+/*
+ * Heaps far larger than the cache: ns per pop and per hold step (pop the top,
+ * push it back with a random decrement) once the sift has to walk trees that
+ * span hundreds of megabytes.  Only the first quarter of the elements is
+ * popped, so every pop still works on the largest trees.
+ *
+ * usage: sift_bench [max_size = 1e8]
+ */
+
+uint64_t sink = 0;
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double ns() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+void print_row(const std::string& name, std::size_t size, const char* op, double ns) {
+    std::cout << "| " << std::left << std::setw(21) << name
+        << "| " << std::left << std::setw(10) << size
+        << "| " << std::left << std::setw(10) << op
+        << "| " << std::left << std::setw(12) << ns << "|\n";
+}
+
+template <class Queue>
+void run(const std::string& name, const std::vector<uint32_t>& keys) {
+    const std::size_t size = keys.size();
+    const std::size_t steps = size / 4;
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<uint32_t> decrement(0, 1 << 16);
+
+    {
+        Queue q(std::less<uint32_t>(), keys);
+
+        Timer t;
+        for (std::size_t i = 0; i < steps; i++) {
+            sink += q.top();
+            q.pop();
+        }
+        print_row(name, size, "pop", t.ns() / (double)steps);
+    }
+
+    {
+        Queue q(std::less<uint32_t>(), keys);
+
+        Timer t;
+        for (std::size_t i = 0; i < steps; i++) {
+            uint32_t x = q.top();
+            q.pop();
+            q.push(x - std::min(x, decrement(gen)));
+        }
+        print_row(name, size, "hold", t.ns() / (double)steps);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 100000000;
+    std::mt19937_64 gen(std::random_device{}());
+
+    std::cout << "+----------------------+-----------+-----------+-------------+\n";
+    std::cout << "| queue                | size      | operation | ns/op       |\n";
+    std::cout << "+----------------------+-----------+-----------+-------------+\n";
+
+    for (std::size_t size = 10000000; size <= max_size; size *= 10) {
+        std::vector<uint32_t> keys(size);
+        for (auto& k : keys)
+            k = (uint32_t)gen();
+
+        run<std::priority_queue<uint32_t>>("std::priority_queue", keys);
+        run<Leonardo::Heap<uint32_t>>("Leonardo::Heap", keys);
+    }
+
+    std::cout << "+----------------------+-----------+-----------+-------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <string>
+#include <utility>
+#include <cstdlib>
+
+#include <vector>
+#include "LeonardoHeap.hpp"
+
+constexpr int TIMES = 5;
+constexpr int SIZE = 1000000;
+constexpr int K = SIZE / 100;
+
+std::vector<int> A(SIZE);
+std::vector<int> B(SIZE);
+
+template <class Algorithm, class Check>
+double measure(Algorithm algorithm, Check check) {
+    double total = 0.0;
+
+    for (int i = 0; i < TIMES; i++) {
+        std::copy(std::begin(A), std::end(A), std::begin(B));
+
+        auto start = std::chrono::steady_clock::now();
+        algorithm(std::begin(B), std::end(B));
+        auto stop = std::chrono::steady_clock::now();
+
+        if (not check(std::begin(B), std::end(B))) {
+            std::cerr << "wrong output\n";
+            std::exit(1);
+        }
+
+        total += std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+
+    return total / (double)TIMES;
+}
+
+template <class Sort>
+double measure(Sort sort) {
+    return measure(sort, [] (auto first, auto last) { return std::is_sorted(first, last); });
+}
+
+// Smallest 1% sorted at the front.
+template <class PartialSort>
+double measure_partial_sort(PartialSort partial_sort) {
+    return measure([partial_sort] (auto first, auto last) { partial_sort(first, first + K, last); },
+        [] (auto first, auto) { return std::is_sorted(first, first + K) and first[K - 1] == K - 1; });
+}
+
+// Median in the middle.
+template <class NthElement>
+double measure_nth_element(NthElement nth_element) {
+    return measure([nth_element] (auto first, auto last) { nth_element(first, first + SIZE / 2, last); },
+        [] (auto first, auto) { return first[SIZE / 2] == SIZE / 2; });
+}
+
+void print_row(const std::string& name) {
+    std::cout << "| " << std::left << std::setw(21) << name
+        << "| " << std::left << std::setw(18) << measure([] (auto first, auto last) { Leonardo::sort(first, last); })
+        << "| " << std::left << std::setw(18) << measure([] (auto first, auto last) { std::sort(first, last); })
+        << "| " << std::left << std::setw(18) << measure([] (auto first, auto last) { std::stable_sort(first, last); })
+        << "|\n";
+    std::cout << "+----------------------+-------------------+-------------------+-------------------+\n";
+}
+
+void print_selection_row(const std::string& name) {
+    std::cout << "| " << std::left << std::setw(21) << name
+        << "| " << std::left << std::setw(18) << measure_partial_sort([] (auto first, auto middle, auto last) { Leonardo::partial_sort(first, middle, last); })
+        << "| " << std::left << std::setw(18) << measure_partial_sort([] (auto first, auto middle, auto last) { std::partial_sort(first, middle, last); })
+        << "| " << std::left << std::setw(18) << measure_nth_element([] (auto first, auto nth, auto last) { Leonardo::nth_element(first, nth, last); })
+        << "| " << std::left << std::setw(18) << measure_nth_element([] (auto first, auto nth, auto last) { std::nth_element(first, nth, last); })
+        << "|\n";
+    std::cout << "+----------------------+-------------------+-------------------+-------------------+-------------------+\n";
+}
+
+int main(void) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::vector<std::pair<std::string, std::vector<int>>> inputs;
+
+    std::iota(std::begin(A), std::end(A), 0);
+    inputs.emplace_back("ascending", A);
+
+    std::reverse(std::begin(A), std::end(A));
+    inputs.emplace_back("descending", A);
+
+    std::shuffle(std::begin(A), std::end(A), gen);
+    inputs.emplace_back("random", A);
+
+    std::iota(std::begin(A), std::end(A), 0);
+    std::uniform_int_distribution<int> pos(0, SIZE - 1);
+    for (int i = 0; i < SIZE / 1000; i++)
+        std::swap(A[pos(gen)], A[pos(gen)]);
+    inputs.emplace_back("few swaps (0.1%)", A);
+
+    std::cout << "+----------------------+-------------------+-------------------+-------------------+\n";
+    std::cout << "| input (ms, n=" << std::left << std::setw(7) << SIZE << ")| Leonardo::sort    | std::sort         | std::stable_sort  |\n";
+    std::cout << "+----------------------+-------------------+-------------------+-------------------+\n";
+
+    for (const auto& input : inputs) {
+        A = input.second;
+        print_row(input.first);
+    }
+
+    std::cout << "\n";
+    std::cout << "+----------------------+-------------------+-------------------+-------------------+-------------------+\n";
+    std::cout << "| input (ms, k=n/100)  | Leo partial_sort  | std::partial_sort | Leo nth_element   | std::nth_element  |\n";
+    std::cout << "+----------------------+-------------------+-------------------+-------------------+-------------------+\n";
+
+    for (const auto& input : inputs) {
+        A = input.second;
+        print_selection_row(input.first);
+    }
+
+    return 0;
+}
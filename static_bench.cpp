@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include <queue>
+#include "LeonardoHeap.hpp"
+#include "StaticLeonardoHeap.hpp"
+
+/*
+ * Small queues: ns per push+pop pair for Leonardo::StaticHeap<uint32_t, N>
+ * against Leonardo::Heap and std::priority_queue, for N from 16 to 4096.  Each
+ * round makes a fresh queue, fills it to N with random keys and drains it; the
+ * rounds add up to about `ops` pairs.  A queue reused across rounds would keep
+ * its memory, and then Heap and StaticHeap run at the same speed.
+ *
+ * usage: static_bench [ops = 1e7]
+ */
+
+uint64_t sink = 0;
+
+// The smallest of a few keys, found by a StaticHeap at compile time.
+constexpr uint32_t smallest_key() {
+    Leonardo::StaticHeap<uint32_t, 8, std::greater<uint32_t>> h;
+
+    for (uint32_t x : {5u, 3u, 8u, 1u, 9u})
+        h.push(x);
+
+    return h.top();
+}
+
+static_assert(smallest_key() == 1, "StaticHeap in a constant expression");
+
+// Flattened so that every queue gets its operations inlined, whatever the compiler does for the other sizes.
+template <class Queue>
+__attribute__((flatten)) double measure(const std::vector<uint32_t>& keys, std::size_t n) {
+    const std::size_t rounds = keys.size() / n;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rounds; r++) {
+        Queue q;
+
+        for (std::size_t i = r * n; i < (r + 1) * n; i++)
+            q.push(keys[i]);
+
+        while (not q.empty()) {
+            sink += q.top();
+            q.pop();
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (double)(rounds * n);
+}
+
+template <std::size_t N>
+void run(const std::vector<uint32_t>& keys) {
+    std::cout << "| " << std::left << std::setw(10) << N
+        << "| " << std::left << std::setw(18) << measure<Leonardo::StaticHeap<uint32_t, N>>(keys, N)
+        << "| " << std::left << std::setw(18) << measure<Leonardo::Heap<uint32_t>>(keys, N)
+        << "| " << std::left << std::setw(20) << measure<std::priority_queue<uint32_t>>(keys, N) << "|\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t ops = argc > 1 ? (std::size_t)std::atof(argv[1]) : 10000000;
+    std::mt19937 gen(std::random_device{}());
+
+    std::vector<uint32_t> keys(ops);
+    for (auto& k : keys)
+        k = (uint32_t)gen();
+
+    std::cout << "+-----------+-------------------+-------------------+---------------------+\n";
+    std::cout << "| N         | StaticHeap (ns)   | Leonardo::Heap    | std::priority_queue |\n";
+    std::cout << "+-----------+-------------------+-------------------+---------------------+\n";
+
+    run<16>(keys);
+    run<64>(keys);
+    run<256>(keys);
+    run<1024>(keys);
+    run<4096>(keys);
+
+    std::cout << "+-----------+-------------------+-------------------+---------------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,359 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+
+#include <vector>
+#include <queue>
+#include "LeonardoHeap.hpp"
+#include "RelaxedLeonardoHeap.hpp"
+#include "CompactRelaxedLeonardoHeap.hpp"
+#include "KeyedLeonardoHeap.hpp"
+
+/*
+ * Wall-clock benchmark: ns per operation for push, pop, the hold model
+ * (pop the top, push it back with a random increment) and construction from
+ * a container, for each heap over sizes 1e3 .. max_size.  Bulk insertion into
+ * a live Leonardo::Heap is compared against a loop of push calls, and batched
+ * extraction through pop_k against a loop of top/pop calls.  The pop/push
+ * and merge rows report ns for moving a whole heap of `size` elements; the
+ * merged heap is then drained, against a heap that got the same 2 * `size`
+ * elements through push.
+ * 256-byte items stop at 1e6 elements.
+ *
+ * usage: time_bench [max_size = 1e7] [csv file = time_bench.csv]
+ */
+
+template <std::size_t N>
+struct Item {
+    uint64_t key;
+    char payload[N - sizeof(uint64_t)];
+
+    Item() = default;
+    Item(uint64_t k) : key(k) {}
+
+    bool operator<(const Item& other) const { return key < other.key; }
+};
+
+uint64_t key_of(int v) { return (uint64_t)v; }
+
+template <std::size_t N>
+uint64_t key_of(const Item<N>& v) { return v.key; }
+
+template <class T>
+T make_value(uint64_t k) { return T(k); }
+
+template <>
+int make_value<int>(uint64_t k) { return (int)(k & 0x7fffffff); }
+
+template <class T>
+struct StdQueue {
+    static constexpr const char* name = "std::priority_queue";
+    std::priority_queue<T> q;
+
+    StdQueue() = default;
+    explicit StdQueue(std::vector<T>&& v) : q(std::less<T>(), std::move(v)) {}
+
+    void push(const T& v) { q.push(v); }
+    void pop() { q.pop(); }
+    const T& top() const { return q.top(); }
+    bool empty() const { return q.empty(); }
+};
+
+template <class T>
+struct LeonardoQueue {
+    static constexpr const char* name = "Leonardo::Heap";
+    Leonardo::Heap<T> q;
+
+    LeonardoQueue() = default;
+    explicit LeonardoQueue(std::vector<T>&& v) : q(std::less<T>(), std::move(v)) {}
+
+    void push(const T& v) { q.push(v); }
+    void pop() { q.pop(); }
+    const T& top() const { return q.top(); }
+    bool empty() const { return q.empty(); }
+};
+
+template <class T>
+struct KeyedQueue {
+    static constexpr const char* name = "Leonardo::KeyedHeap";
+    Leonardo::KeyedHeap<uint64_t, T> q;
+
+    KeyedQueue() = default;
+    explicit KeyedQueue(std::vector<T>&& v) {
+        for (T& x : v)
+            q.push(key_of(x), std::move(x));
+    }
+
+    void push(const T& v) { q.push(key_of(v), v); }
+    void pop() { q.pop(); }
+    const T& top() const { return q.top(); }
+    bool empty() const { return q.empty(); }
+};
+
+template <class T>
+struct RelaxedQueue {
+    static constexpr const char* name = "Leonardo::RelaxedHeap";
+    Leonardo::RelaxedHeap<T> q;
+
+    RelaxedQueue() = default;
+    explicit RelaxedQueue(std::vector<T>&& v) {
+        for (const T& x : v)
+            q.push(x);
+    }
+
+    void push(const T& v) { q.push(v); }
+    void pop() { q.pop(); }
+    T top() const { return q.top(); }
+    bool empty() const { return q.empty(); }
+};
+
+template <class T>
+struct CompactQueue {
+    static constexpr const char* name = "Leonardo::CompactRelaxedHeap";
+    Leonardo::CompactRelaxedHeap<T> q;
+
+    CompactQueue() = default;
+    explicit CompactQueue(std::vector<T>&& v) {
+        q.reserve(v.size());
+        for (const T& x : v)
+            q.push(x);
+    }
+
+    void push(const T& v) { q.push(v); }
+    void pop() { q.pop(); }
+    const T& top() const { return q.top(); }
+    bool empty() const { return q.empty(); }
+};
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double ns() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+std::ofstream csv;
+uint64_t sink = 0;
+
+void report(const char* queue, const char* type, std::size_t size, const char* op, double ns_per_op) {
+    std::cout << "| " << std::left << std::setw(29) << queue
+        << "| " << std::left << std::setw(9) << type
+        << "| " << std::left << std::setw(10) << size
+        << "| " << std::left << std::setw(12) << op
+        << "| " << std::left << std::setw(12) << ns_per_op << "|\n";
+    csv << queue << ',' << type << ',' << size << ',' << op << ',' << ns_per_op << '\n';
+}
+
+template <template <class> class Queue, class T>
+void run(const char* type, const std::vector<uint64_t>& keys, std::mt19937_64& gen) {
+    const std::size_t size = keys.size();
+
+    {
+        Queue<T> q;
+
+        Timer t;
+        for (uint64_t k : keys)
+            q.push(make_value<T>(k));
+        report(Queue<T>::name, type, size, "push", t.ns() / (double)size);
+
+        Timer u;
+        while (not q.empty()) {
+            sink += key_of(q.top());
+            q.pop();
+        }
+        report(Queue<T>::name, type, size, "pop", u.ns() / (double)size);
+    }
+
+    {
+        std::vector<T> v;
+        v.reserve(size);
+        for (uint64_t k : keys)
+            v.push_back(make_value<T>(k));
+
+        Timer t;
+        Queue<T> q(std::move(v));
+        report(Queue<T>::name, type, size, "construct", t.ns() / (double)size);
+
+        std::uniform_int_distribution<uint64_t> increment(0, 1 << 20);
+
+        Timer u;
+        for (std::size_t i = 0; i < size; i++) {
+            T x = q.top();
+            q.pop();
+            q.push(make_value<T>(key_of(x) - increment(gen)));
+        }
+        report(Queue<T>::name, type, size, "hold", u.ns() / (double)size);
+    }
+}
+
+// Merge `size` elements into a live Leonardo::Heap of `size` elements, in batches of BATCH.
+template <class T>
+void run_batches(const char* type, const std::vector<uint64_t>& keys) {
+    constexpr std::size_t BATCH = 1000;
+    const std::size_t size = keys.size();
+
+    std::vector<T> v;
+    v.reserve(size);
+    for (uint64_t k : keys)
+        v.push_back(make_value<T>(k));
+
+    {
+        Leonardo::Heap<T> q(std::less<T>(), v);
+
+        Timer t;
+        for (std::size_t i = 0; i < size; i += BATCH)
+            for (std::size_t j = i; j < std::min(i + BATCH, size); j++)
+                q.push(v[j]);
+        report("Leonardo::Heap", type, size, "push batch", t.ns() / (double)size);
+    }
+
+    {
+        Leonardo::Heap<T> q(std::less<T>(), v);
+
+        Timer t;
+        for (std::size_t i = 0; i < size; i += BATCH)
+            q.push_range(std::begin(v) + i, std::begin(v) + std::min(i + BATCH, size));
+        report("Leonardo::Heap", type, size, "push_range", t.ns() / (double)size);
+    }
+}
+
+// Drain a heap of `size` elements in batches of BATCH, one pop at a time and through pop_k.
+template <class Queue, class T>
+void run_pop_k(const char* name, const char* type, const std::vector<uint64_t>& keys) {
+    constexpr std::size_t BATCH = 256;
+    const std::size_t size = keys.size();
+    std::vector<T> out;
+    out.reserve(BATCH);
+
+    {
+        Queue q;
+        for (uint64_t k : keys)
+            q.push(make_value<T>(k));
+
+        Timer t;
+        while (not q.empty()) {
+            out.clear();
+            for (std::size_t i = 0; i < BATCH and not q.empty(); i++) {
+                out.push_back(q.top());
+                q.pop();
+            }
+        }
+        report(name, type, size, "pop batch", t.ns() / (double)size);
+    }
+
+    {
+        Queue q;
+        for (uint64_t k : keys)
+            q.push(make_value<T>(k));
+
+        Timer t;
+        while (not q.empty()) {
+            out.clear();
+            q.pop_k(BATCH, std::back_inserter(out));
+        }
+        report(name, type, size, "pop_k", t.ns() / (double)size);
+    }
+}
+
+// Hand a RelaxedHeap of `size` elements over to another one of the same size.
+template <class T>
+void run_merge(const char* type, const std::vector<uint64_t>& keys) {
+    const std::size_t size = keys.size();
+
+    {
+        Leonardo::RelaxedHeap<T> a, b;
+        for (uint64_t k : keys) {
+            a.push(make_value<T>(k));
+            b.push(make_value<T>(k));
+        }
+
+        Timer t;
+        while (not b.empty()) {
+            a.push(b.top());
+            b.pop();
+        }
+        report("Leonardo::RelaxedHeap", type, size, "pop/push", t.ns());
+    }
+
+    {
+        Leonardo::RelaxedHeap<T> a, b;
+        for (uint64_t k : keys) {
+            a.push(make_value<T>(k));
+            b.push(make_value<T>(k));
+        }
+
+        Timer t;
+        a.merge(std::move(b));
+        report("Leonardo::RelaxedHeap", type, size, "merge", t.ns());
+
+        t = Timer();
+        while (not a.empty()) {
+            sink += key_of(a.top());
+            a.pop();
+        }
+        report("Leonardo::RelaxedHeap", type, size, "pop merged", t.ns() / (double)(2 * size));
+    }
+
+    {
+        Leonardo::RelaxedHeap<T> a;
+        for (uint64_t k : keys) {
+            a.push(make_value<T>(k));
+            a.push(make_value<T>(k));
+        }
+
+        Timer t;
+        while (not a.empty()) {
+            sink += key_of(a.top());
+            a.pop();
+        }
+        report("Leonardo::RelaxedHeap", type, size, "pop unmerged", t.ns() / (double)(2 * size));
+    }
+}
+
+template <class T>
+void run_all(const char* type, std::size_t max_size, std::mt19937_64& gen) {
+    for (std::size_t size = 1000; size <= max_size; size *= 10) {
+        std::vector<uint64_t> keys(size);
+        for (auto& k : keys)
+            k = gen() >> 1;
+
+        run<StdQueue, T>(type, keys, gen);
+        run<LeonardoQueue, T>(type, keys, gen);
+        run<KeyedQueue, T>(type, keys, gen);
+        run<RelaxedQueue, T>(type, keys, gen);
+        run<CompactQueue, T>(type, keys, gen);
+        run_batches<T>(type, keys);
+        run_pop_k<Leonardo::Heap<T>, T>("Leonardo::Heap", type, keys);
+        run_pop_k<Leonardo::RelaxedHeap<T>, T>("Leonardo::RelaxedHeap", type, keys);
+        run_merge<T>(type, keys);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t max_size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 10000000;
+    csv.open(argc > 2 ? argv[2] : "time_bench.csv");
+    csv << "queue,type,size,op,ns_per_op\n";
+
+    std::mt19937_64 gen(std::random_device{}());
+
+    std::cout << "+------------------------------+----------+-----------+-------------+-------------+\n";
+    std::cout << "| queue                        | type     | size      | operation   | ns/op       |\n";
+    std::cout << "+------------------------------+----------+-----------+-------------+-------------+\n";
+
+    run_all<int>("int", max_size, gen);
+    run_all<Item<16>>("16 bytes", max_size, gen);
+    run_all<Item<64>>("64 bytes", max_size, gen);
+    run_all<Item<256>>("256 bytes", std::min<std::size_t>(max_size, 1000000), gen);
+
+    std::cout << "+------------------------------+----------+-----------+-------------+-------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include <queue>
+#include "TimerLeonardoHeap.hpp"
+
+/*
+ * A timer service holding `active` timers with deadlines spread over the next
+ * `active` ticks.  Time moves 100 ticks per step; every timer that fires is
+ * rescheduled, and one in four also cancels and reschedules a random other
+ * timer.  ns per fired timer, with the rescheduling and cancelling it causes,
+ * for Leonardo::TimerQueue against a std::priority_queue with tombstones.
+ *
+ * usage: timer_bench [active = 1e6] [fired = 1e7]
+ */
+
+uint64_t sink = 0;
+
+constexpr uint64_t TICK = 100;
+
+typedef Leonardo::TimerQueue<uint32_t>::TimerId TimerId;
+
+// The usual hand-rolled service: tombstones are only noticed when they reach the top.
+class PriorityQueueTimers {
+    struct Entry {
+        uint64_t deadline;
+        uint32_t timer;
+        uint32_t generation;
+    };
+
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return b.deadline < a.deadline;
+        }
+    };
+
+    std::priority_queue<Entry, std::vector<Entry>, Later> heap;
+    std::vector<uint32_t> generation;
+
+    public:
+
+    explicit PriorityQueueTimers(std::size_t timers) : generation(timers, 0) {}
+
+    TimerId schedule(uint64_t deadline, uint32_t timer) {
+        heap.push(Entry {deadline, timer, generation[timer]});
+        return TimerId {timer, generation[timer]};
+    }
+
+    bool cancel(TimerId id) {
+        if (generation[id.slot] != id.generation)
+            return false;
+
+        generation[id.slot]++;
+        return true;
+    }
+
+    template <class Callback>
+    std::size_t expire_until(uint64_t now, Callback&& callback) {
+        std::size_t fired = 0;
+
+        while (not heap.empty() and heap.top().deadline <= now) {
+            Entry entry = heap.top();
+            heap.pop();
+
+            if (generation[entry.timer] != entry.generation)
+                continue;
+
+            generation[entry.timer]++;
+            fired++;
+            callback(entry.deadline, entry.timer);
+        }
+
+        return fired;
+    }
+};
+
+template <class Service>
+void run(const std::string& name, Service service, std::size_t active, std::size_t target) {
+    std::mt19937_64 gen(1);
+    std::vector<TimerId> ids(active);
+    uint64_t now = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < active; i++)
+        ids[i] = service.schedule(gen() % active, i);
+    double schedule_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double)active;
+
+    std::size_t fired = 0;
+
+    start = std::chrono::steady_clock::now();
+    while (fired < target) {
+        now += TICK;
+        fired += service.expire_until(now, [&] (uint64_t, uint32_t timer) {
+            ids[timer] = service.schedule(now + 1 + gen() % active, timer);
+
+            if (0 == (gen() & 3)) {
+                uint32_t other = (uint32_t)(gen() % active);
+
+                if (service.cancel(ids[other]))
+                    ids[other] = service.schedule(now + 1 + gen() % active, other);
+            }
+
+            sink += timer;
+        });
+    }
+    double fire_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double)fired;
+
+    std::cout << "| " << std::left << std::setw(29) << name
+        << "| " << std::left << std::setw(14) << schedule_ns
+        << "| " << std::left << std::setw(14) << fire_ns << "|\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t active = argc > 1 ? (std::size_t)std::atof(argv[1]) : 1000000;
+    std::size_t target = argc > 2 ? (std::size_t)std::atof(argv[2]) : 10000000;
+
+    std::cout << "+------------------------------+---------------+---------------+\n";
+    std::cout << "| service                      | schedule (ns) | per fire (ns) |\n";
+    std::cout << "+------------------------------+---------------+---------------+\n";
+
+    run("std::priority_queue", PriorityQueueTimers(active), active, target);
+    run("Leonardo::TimerQueue", Leonardo::TimerQueue<uint32_t>(), active, target);
+    run("TimerQueue, resolution 64", Leonardo::TimerQueue<uint32_t>(64), active, target);
+    run("TimerQueue, 1024 buckets", Leonardo::TimerQueue<uint32_t>(1, 1024), active, target);
+    run("TimerQueue, 16384 buckets", Leonardo::TimerQueue<uint32_t>(1, 16384), active, target);
+
+    std::cout << "+------------------------------+---------------+---------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#include <vector>
+#include <queue>
+#include "BoundedLeonardoHeap.hpp"
+
+/*
+ * Streaming top-k: keep the K smallest of `size` values.  Leonardo::BoundedHeap
+ * offer() against std::priority_queue push+pop and std::partial_sort over the
+ * whole buffered stream, for random, ascending and descending streams.
+ *
+ * usage: topk_bench [size = 1e7] [K = 1e4]
+ */
+
+uint64_t sink = 0;
+
+template <class TopK>
+double measure(const std::vector<uint64_t>& stream, TopK top_k) {
+    auto start = std::chrono::steady_clock::now();
+    sink += top_k(stream);
+    auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void print_row(const std::string& name, double ms) {
+    std::cout << "| " << std::left << std::setw(29) << name << "| " << std::left << std::setw(14) << ms << "|\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t size = argc > 1 ? (std::size_t)std::atof(argv[1]) : 10000000;
+    std::size_t k = argc > 2 ? (std::size_t)std::atof(argv[2]) : 10000;
+
+    std::mt19937_64 gen(std::random_device{}());
+    std::vector<uint64_t> random(size), ascending(size), descending(size);
+
+    for (auto& x : random)
+        x = gen();
+
+    std::iota(std::begin(ascending), std::end(ascending), 0);
+    std::copy(std::rbegin(ascending), std::rend(ascending), std::begin(descending));
+
+    auto bounded = [k] (const std::vector<uint64_t>& stream) {
+        Leonardo::BoundedHeap<uint64_t> heap(k);
+
+        for (uint64_t x : stream)
+            heap.offer(x);
+
+        return heap.top();
+    };
+
+    auto priority_queue = [k] (const std::vector<uint64_t>& stream) {
+        std::priority_queue<uint64_t> heap;
+
+        for (uint64_t x : stream) {
+            if (heap.size() < k)
+                heap.push(x);
+            else if (x < heap.top()) {
+                heap.push(x);
+                heap.pop();
+            }
+        }
+
+        return heap.top();
+    };
+
+    auto partial_sort = [k] (const std::vector<uint64_t>& stream) {
+        std::vector<uint64_t> buffer(stream);
+        std::partial_sort(std::begin(buffer), std::begin(buffer) + k, std::end(buffer));
+        return buffer[k - 1];
+    };
+
+    const std::pair<const char*, const std::vector<uint64_t>*> inputs[] = {
+        {"random", &random}, {"ascending", &ascending}, {"descending", &descending}
+    };
+
+    for (const auto& input : inputs) {
+        std::cout << "+------------------------------+---------------+\n";
+        std::cout << "| " << std::left << std::setw(29) << (std::string(input.first) + " stream") << "| time (ms)     |\n";
+        std::cout << "+------------------------------+---------------+\n";
+
+        print_row("Leonardo::BoundedHeap", measure(*input.second, bounded));
+        print_row("std::priority_queue", measure(*input.second, priority_queue));
+        print_row("std::partial_sort", measure(*input.second, partial_sort));
+    }
+
+    std::cout << "+------------------------------+---------------+\n";
+
+    return sink == 42 ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <string>
+#include <iterator>
+#include <cstdint>
+#include <cstdlib>
+
+#include "LeonardoHeap.hpp"
+
+/*
+ * Checks of the 64-bit heap shapes.  HeapCode::increase() and decrease() are
+ * compared against heap_code(n + 1) and heap_code(n - 1) for random n up to
+ * 2^64, and round-tripped on shapes whose tree orders lie more than 64 apart,
+ * where the prefix needs its upper half.  is_heap and heap_code then run over
+ * a counting iterator of `size` elements, by default just above 2^32.
+ * Returns 1 if any check fails.
+ *
+ * usage: wide_test [size = 2^32 + 12345] [cases = 2e6]
+ */
+
+typedef unsigned __int128 total_type;
+
+// Position p holds p, except the element at `defect`, which holds 0.
+struct CountingIterator {
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef uint64_t value_type;
+    typedef int64_t difference_type;
+    typedef const uint64_t* pointer;
+    typedef uint64_t reference;
+
+    uint64_t pos;
+    uint64_t defect;
+
+    uint64_t operator*() const { return pos == defect ? 0 : pos; }
+    uint64_t operator[](difference_type n) const { return *(*this + n); }
+
+    CountingIterator& operator++() { pos++; return *this; }
+    CountingIterator operator++(int) { CountingIterator old = *this; pos++; return old; }
+    CountingIterator& operator--() { pos--; return *this; }
+    CountingIterator operator--(int) { CountingIterator old = *this; pos--; return old; }
+    CountingIterator& operator+=(difference_type n) { pos += (uint64_t)n; return *this; }
+    CountingIterator& operator-=(difference_type n) { pos -= (uint64_t)n; return *this; }
+
+    friend CountingIterator operator+(CountingIterator it, difference_type n) { return it += n; }
+    friend CountingIterator operator+(difference_type n, CountingIterator it) { return it += n; }
+    friend CountingIterator operator-(CountingIterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const CountingIterator& a, const CountingIterator& b) { return (difference_type)(a.pos - b.pos); }
+
+    friend bool operator==(const CountingIterator& a, const CountingIterator& b) { return a.pos == b.pos; }
+    friend bool operator!=(const CountingIterator& a, const CountingIterator& b) { return a.pos != b.pos; }
+    friend bool operator<(const CountingIterator& a, const CountingIterator& b) { return a.pos < b.pos; }
+    friend bool operator>(const CountingIterator& a, const CountingIterator& b) { return a.pos > b.pos; }
+    friend bool operator<=(const CountingIterator& a, const CountingIterator& b) { return a.pos <= b.pos; }
+    friend bool operator>=(const CountingIterator& a, const CountingIterator& b) { return a.pos >= b.pos; }
+};
+
+bool same(const Leonardo::HeapCode& a, const Leonardo::HeapCode& b) {
+    return a.prefix == b.prefix and a.shift == b.shift;
+}
+
+// Number of elements in the heap of shape `code`, walking the roots as pop does.
+total_type total(Leonardo::HeapCode code) {
+    if (not code.prefix)
+        return 0;
+
+    total_type sum = Leonardo::number[code.shift];
+
+    while (code.prefix > 1LL) {
+        code.unguard_remove_least_digit();
+        sum += Leonardo::number[code.shift];
+    }
+
+    return sum;
+}
+
+int failures = 0;
+
+void report(const std::string& check, uint64_t cases, bool ok, double ms) {
+    failures += not ok;
+
+    std::cout << "| " << std::left << std::setw(39) << check
+        << "| " << std::left << std::setw(12) << cases
+        << "| " << std::left << std::setw(7) << (ok ? "ok" : "FAILED")
+        << "| " << std::left << std::setw(12) << ms << "|\n";
+}
+
+struct Timer {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+int main(int argc, char* argv[]) {
+    uint64_t size = argc > 1 ? (uint64_t)std::atof(argv[1]) : (1ULL << 32) + 12345;
+    uint64_t cases = argc > 2 ? (uint64_t)std::atof(argv[2]) : 2000000;
+    std::mt19937_64 gen(std::random_device{}());
+
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+    std::cout << "| check                                  | cases       | result | time (ms)   |\n";
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+
+    {
+        Timer t;
+        bool ok = true;
+
+        // n in [1, 2^64 - 2], so that both neighbours are valid sizes.
+        for (uint64_t i = 0; i < cases and ok; i++) {
+            uint64_t n = 1 + gen() % (~0ULL - 1);
+            Leonardo::HeapCode up = Leonardo::heap_code(n);
+            Leonardo::HeapCode down = up;
+
+            up.increase();
+            down.decrease();
+
+            ok = total(Leonardo::heap_code(n)) == n
+                and same(up, Leonardo::heap_code(n + 1))
+                and same(down, Leonardo::heap_code(n - 1));
+        }
+
+        report("increase/decrease against heap_code", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+        uint64_t count = 0;
+
+        // A big tree followed by a small one: the prefix holds bits more than 64 apart.
+        for (int big = 66; big < (int)Leonardo::number_count and ok; big++) {
+            for (int small = 0; small + 64 < big and ok; small++, count++) {
+                uint64_t n = Leonardo::number[big] + Leonardo::number[small];
+                Leonardo::HeapCode code = Leonardo::heap_code(n);
+                Leonardo::HeapCode trip = code;
+
+                trip.decrease();
+                trip.increase();
+                ok = code.count_trees() == 2 and Leonardo::number[code.shift] == Leonardo::number[small]
+                    and same(trip, code) and total(code) == n;
+
+                trip.increase();
+                trip.decrease();
+                ok = ok and same(trip, code);
+            }
+        }
+
+        report("round trips, orders > 64 apart", count, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        bool ok = true;
+
+        // Walk down from a two-tree shape 90 orders wide, one element at a time.
+        uint64_t n = Leonardo::number[90] + Leonardo::number[0] + cases / 2;
+        Leonardo::HeapCode code = Leonardo::heap_code(n);
+
+        for (uint64_t i = 0; i < cases and ok; i++, n--) {
+            code.decrease();
+            ok = total(code) == n - 1;
+        }
+
+        ok = ok and same(code, Leonardo::heap_code(n));
+        report("decrease from L(90) + L(0) + cases/2", cases, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        CountingIterator first {0, size}, last {size, size};
+        bool ok = total(Leonardo::heap_code(first, last)) == size;
+
+        report("heap_code over a counting iterator", size, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        CountingIterator first {0, size}, last {size, size};
+        bool ok = Leonardo::is_heap(first, last);
+
+        report("is_heap, ascending", size, ok, t.ms());
+    }
+
+    {
+        Timer t;
+        // The last element holds 0, so the largest root is out of place.
+        CountingIterator first {0, size - 1}, last {size, size - 1};
+        bool ok = not Leonardo::is_heap(first, last);
+
+        report("is_heap, last element 0", size, ok, t.ms());
+    }
+
+    std::cout << "+----------------------------------------+-------------+--------+-------------+\n";
+
+    return failures ? 1 : 0;
+}